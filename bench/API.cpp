@@ -0,0 +1,125 @@
+#include "API.h"
+
+#include "Sim.h"
+#include "Stats.h"
+
+// An implementation of the API that is backed by the in-memory Sim rather
+// than by the mms simulator, which the benchmark links in place of the one
+// in src/. Visualization commands are simply dropped.
+
+THREAD_LOCAL bool API::m_buffered = false;
+THREAD_LOCAL int API::m_flushCount = 0;
+
+int API::mazeWidth() {
+    Stats::count(Stats::API_SIZE_QUERIES);
+    return Sim::width();
+}
+
+int API::mazeHeight() {
+    Stats::count(Stats::API_SIZE_QUERIES);
+    return Sim::height();
+}
+
+bool API::wallFront() {
+    Stats::count(Stats::API_WALL_QUERIES);
+    return Sim::wall(0);
+}
+
+bool API::wallRight() {
+    Stats::count(Stats::API_WALL_QUERIES);
+    return Sim::wall(1);
+}
+
+bool API::wallLeft() {
+    Stats::count(Stats::API_WALL_QUERIES);
+    return Sim::wall(3);
+}
+
+int API::readWalls() {
+    Stats::count(Stats::API_WALL_QUERIES);
+    return Sim::wall(0) << 0 | Sim::wall(1) << 1 | Sim::wall(3) << 3;
+}
+
+void API::moveForward() {
+    Stats::count(Stats::API_MOVES);
+    Sim::moveForward(1);
+}
+
+void API::moveForward(int distance) {
+    Stats::count(Stats::API_MOVES);
+    Sim::moveForward(distance);
+}
+
+void API::startMoveForward() {
+    // The simulated mouse moves instantly, so there's nothing to wait for
+    Stats::count(Stats::API_MOVES);
+    Sim::moveForward(1);
+}
+
+void API::finishMove() {
+}
+
+void API::turnRight() {
+    Stats::count(Stats::API_TURNS);
+    Sim::turn(1);
+}
+
+void API::turnLeft() {
+    Stats::count(Stats::API_TURNS);
+    Sim::turn(3);
+}
+
+void API::setWall(int x, int y, char direction) {
+}
+
+void API::clearWall(int x, int y, char direction) {
+}
+
+void API::setColor(int x, int y, char color) {
+}
+
+void API::clearColor(int x, int y) {
+}
+
+void API::clearAllColor() {
+}
+
+void API::setText(int x, int y, const std::string& text) {
+}
+
+void API::clearText(int x, int y) {
+}
+
+void API::clearAllText() {
+}
+
+bool API::wasReset() {
+    Stats::count(Stats::API_RESET_QUERIES);
+    return false;
+}
+
+void API::ackReset() {
+    Stats::count(Stats::API_RESET_QUERIES);
+}
+
+void API::setBuffered(bool buffered) {
+    m_buffered = buffered;
+}
+
+int API::getFlushCount() {
+    return m_flushCount;
+}
+
+void API::resetFlushCount() {
+    m_flushCount = 0;
+}
+
+bool API::useBinaryProtocol(const char* socketPath) {
+    // There's no protocol at all in process
+    return false;
+}
+
+bool API::recordTrace(const char* path) {
+    // Nor anything worth replaying, since the Sim is deterministic already
+    return false;
+}
@@ -0,0 +1,637 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <link.h>
+#include <pthread.h>
+
+#include "Algo.h"
+#include "BucketQueue.h"
+#include "CostModel.h"
+#include "Heap.h"
+#include "Maze.h"
+#include "Sim.h"
+#include "Stats.h"
+
+// Runs the algorithm against each maze in turn, in process, and reports the
+// planning work done up to the first arrival at the center. Usage:
+//
+//     mackbench [--random N] [--size S] [--moves M] [--threads T] [--frontier R]
+//               [--sweep] [--turn RANGE] [--straight RANGE] [--floor RANGE]
+//               [--sample K] [maze files...]
+//
+// With no maze files, N random S x S mazes are generated (10 and 16 by
+// default). A run ends at the second arrival at the center (i.e., after the
+// first speed run), or after M moves (10000 by default). The mazes are solved
+// by T threads in parallel (1 by default, or one per core if T is 0).
+//
+// With --frontier, it instead compares the frontiers that Dijkstra's algo can
+// be built with (see Algo::BUCKET_QUEUE), by timing R full-maze searches from
+// the origin with each of them, with every wall known. Each maze is searched
+// both without and with A*'s estimates (see Algo::A_STAR), since only the
+// latter push cells beyond the BucketQueue's ring of buckets.
+//
+// With --sweep, it instead tunes the parameters of the cost model (see
+// CostParameters): it runs the algorithm against every maze with each set of
+// parameters, and ranks the sets by the total time of the speed runs, as
+// estimated by the Sim from the default MotionProfile. Each RANGE is either a
+// single value or LOW:HIGH:STEP, and by default is the value used by
+// Algo::CostModel. Every combination is tried, unless --sample is given, in
+// which case K combinations are drawn at random (and deterministically).
+
+namespace {
+
+// Discards everything written to it, so that the algorithm's logging
+// doesn't get timed along with it (failed assertions bypass std::cerr, so
+// they're still reported, and a maze too large for this build is reported
+// by prepare() rather than by the algorithm)
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) {
+        return c;
+    }
+};
+
+// The stack that each thread gets for itself, on top of its thread-local
+// storage (the usual default)
+const size_t STACK_SIZE = 8 << 20;
+
+// The size of each thread's thread-local storage, i.e., of its copy of all
+// of the solver's state, which grows with the square of MAX_MAZE_SIZE
+size_t getThreadLocalSize() {
+    size_t size = 0;
+    dl_iterate_phdr([](dl_phdr_info* info, size_t, void* data) {
+        for (int i = 0; i < info->dlpi_phnum; i += 1) {
+            if (info->dlpi_phdr[i].p_type == PT_TLS) {
+                *static_cast<size_t*>(data) += info->dlpi_phdr[i].p_memsz;
+            }
+        }
+        return 0;
+    }, &size);
+    return size;
+}
+
+void* runWork(void* work) {
+    (*static_cast<const std::function<void()>*>(work))();
+    return NULL;
+}
+
+// Runs the work on the given number of threads at once, and waits for all of
+// them to finish. glibc carves each thread's thread-local storage out of its
+// stack, so rather than std::thread, whose stack is a fixed 8 MB however large
+// the solver's state is, the threads are started with room for both. Since
+// the threads share the work, it all gets done as long as any of them starts,
+// so this returns false only if none of them can be started.
+bool runThreads(int numThreads, const std::function<void()>& work) {
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    pthread_attr_setstacksize(&attributes, STACK_SIZE + getThreadLocalSize());
+    std::vector<pthread_t> threads;
+    void* argument = const_cast<std::function<void()>*>(&work);
+    for (int t = 0; t < numThreads; t += 1) {
+        pthread_t thread;
+        if (pthread_create(&thread, &attributes, runWork, argument) != 0) {
+            break;
+        }
+        threads.push_back(thread);
+    }
+    pthread_attr_destroy(&attributes);
+    for (size_t t = 0; t < threads.size(); t += 1) {
+        pthread_join(threads[t], NULL);
+    }
+    return !threads.empty();
+}
+
+void printHeader() {
+    std::cout << std::left << std::setw(24) << "maze" << std::right
+              << std::setw(7) << "steps"
+              << std::setw(7) << "cells"
+              << std::setw(7) << "plans"
+              << std::setw(10) << "plan_us"
+              << std::setw(9) << "pushes"
+              << std::setw(9) << "pops"
+              << std::setw(9) << "updates"
+              << std::setw(9) << "relaxes"
+              << std::setw(9) << "expands"
+              << std::setw(7) << "run"
+              << "  status" << std::endl;
+}
+
+void printRow(const std::string& name, const Sample& sample, int run, const char* status) {
+    std::cout << std::left << std::setw(24) << name << std::right
+              << std::setw(7) << sample.steps
+              << std::setw(7) << sample.cellsMoved
+              << std::setw(7) << sample.plans
+              << std::setw(10) << sample.planNanoseconds / 1000
+              << std::setw(9) << sample.heapPushes
+              << std::setw(9) << sample.heapPops
+              << std::setw(9) << sample.heapUpdates
+              << std::setw(9) << sample.relaxations
+              << std::setw(9) << sample.expansions
+              << std::setw(7) << run
+              << "  " << status << std::endl;
+}
+
+void add(Sample* total, const Sample& sample) {
+    total->steps += sample.steps;
+    total->cellsMoved += sample.cellsMoved;
+    total->plans += sample.plans;
+    total->planNanoseconds += sample.planNanoseconds;
+    total->heapPushes += sample.heapPushes;
+    total->heapPops += sample.heapPops;
+    total->heapUpdates += sample.heapUpdates;
+    total->relaxations += sample.relaxations;
+    total->expansions += sample.expansions;
+}
+
+// The costs that the frontiers are compared with
+const CostTable<Maze::MAX_LENGTH> COSTS(FastStraightAways::parameters());
+
+// Estimates the cost from each cell to the center just as Algo::setEstimates()
+// does, i.e., from the bounding box of the center cells
+void setCenterEstimates() {
+    byte minX = (Maze::getWidth() - 1) / 2;
+    byte maxX = Maze::getWidth() / 2;
+    byte minY = (Maze::getHeight() - 1) / 2;
+    byte maxY = Maze::getHeight() / 2;
+    for (byte x = 0; x < Maze::getWidth(); x += 1) {
+        for (byte y = 0; y < Maze::getHeight(); y += 1) {
+            byte dx = x < minX ? minX - x : (maxX < x ? x - maxX : 0);
+            byte dy = y < minY ? minY - y : (maxY < y ? y - maxY : 0);
+            twobyte moves = dx + dy;
+            twobyte turns = 0 < dx && 0 < dy ? 1 : 0;
+            Maze::setEstimate(Maze::getCell(x, y), (
+                turns * COSTS.turnCost + (moves - turns) * COSTS.minCost
+            ));
+        }
+    }
+}
+
+// Settles every reachable cell, just as Algo::buildField() does, but with the
+// given frontier, and returns the sum of the distances, along with whether
+// the frontier popped the cells in order of priority. With A*, the cells are
+// ordered by their estimated cost to the center too, which the search raises
+// as Algo::raiseEstimate() does, so that priorities never decrease.
+template <class Frontier>
+unsigned long search(cellindex start, bool aStar, bool* ordered) {
+    if (aStar) {
+        setCenterEstimates();
+    }
+    else {
+        Maze::clearAllEstimates();
+    }
+    Maze::clearAllDiscovered();
+    Maze::clearAllNext();
+    Maze::setDiscovered(start, true);
+    Maze::setDistance(start, 0);
+    Maze::setStraightAwayLength(start, 0);
+    Frontier::push(start);
+    unsigned long sum = 0;
+    twobyte last = 0;
+    *ordered = true;
+    while (0 < Frontier::size()) {
+        cellindex cell = Frontier::pop();
+        sum += Maze::getDistance(cell);
+        *ordered = *ordered && last <= Maze::getPriority(cell);
+        last = Maze::getPriority(cell);
+        byte openDirections = Maze::getOpenDirections(cell);
+        for (byte direction = 0; direction < 4; direction += 1) {
+            if (!((openDirections >> direction) & 1)) {
+                continue;
+            }
+            cellindex neighbor = Maze::getNeighbor(cell, direction);
+            byte directionFromNeighbor = (direction + 2) % 4;
+            bool straight = (
+                Maze::hasNext(cell) &&
+                Maze::getNextDirection(cell) == directionFromNeighbor
+            );
+            twobyte cost = Maze::getDistance(cell) + (
+                straight
+                ? COSTS.straightAwayCost[Maze::getStraightAwayLength(cell) + 1]
+                : COSTS.turnCost
+            );
+            if (Maze::getDiscovered(neighbor) && Maze::getDistance(neighbor) <= cost) {
+                continue;
+            }
+            Maze::setDistance(neighbor, cost);
+            Maze::setNextDirection(neighbor, directionFromNeighbor);
+            Maze::setStraightAwayLength(neighbor, (
+                straight ? Maze::getStraightAwayLength(cell) + 1 : 1
+            ));
+            Maze::setDiscovered(neighbor, true);
+            if (aStar && Maze::getPriority(neighbor) < Maze::getPriority(cell)) {
+                Maze::setEstimate(neighbor, Maze::getPriority(cell) - cost);
+            }
+            if (!Frontier::contains(neighbor)) {
+                Frontier::push(neighbor);
+            }
+            else {
+                Frontier::update(neighbor);
+            }
+        }
+    }
+    return sum;
+}
+
+// Returns the average time of a full-maze search, in nanoseconds
+template <class Frontier>
+double time(int repetitions, bool aStar, unsigned long* sum, bool* ordered) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repetitions; i += 1) {
+        *sum = search<Frontier>(Maze::getCell(0, 0), aStar, ordered);
+    }
+    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() /
+        static_cast<double>(repetitions);
+}
+
+void compareFrontiers(const std::string& name, int repetitions, bool aStar) {
+    Sim::reveal();
+    unsigned long heapSum = 0;
+    unsigned long bucketSum = 0;
+    bool heapOrdered = false;
+    bool bucketOrdered = false;
+    double heap = time<Heap>(repetitions, aStar, &heapSum, &heapOrdered);
+    double bucket = time<BucketQueue>(repetitions, aStar, &bucketSum, &bucketOrdered);
+
+    // The frontiers break ties differently, which can leave a cell with an
+    // equally short route that ends in a different straightaway, and thus
+    // change the distances of the cells beyond it. So the distances needn't
+    // agree exactly, but the order of the priorities must.
+    const char* status = (
+        !heapOrdered || !bucketOrdered ? "MISORDERED" :
+        heapSum == bucketSum ? "ok" : "ok (ties)"
+    );
+    std::cout << std::left << std::setw(24) << name << std::right << std::fixed
+              << std::setprecision(0)
+              << std::setw(10) << heap
+              << std::setw(10) << bucket
+              << std::setw(9) << std::setprecision(2) << heap / bucket
+              << "  " << status << std::endl;
+}
+
+// What to run the algorithm against, and for how long
+struct Options {
+    int numRandom;
+    int size;
+    int maxMoves;
+    std::vector<std::string> paths;
+};
+
+// The outcome of running the algorithm against one maze
+struct Result {
+    std::string name;
+    std::string error;
+    Sample sample;
+    int moves;
+    float explorationTime;
+    float speedRunTime;
+    const char* status;
+};
+
+// Loads or generates the i-th maze into this thread's Sim, and checks that
+// it fits this build (which Algo::solve() would only report on std::cerr)
+bool prepare(const Options& options, int i, Result* result) {
+    if (options.paths.empty()) {
+        std::ostringstream stream;
+        stream << "random-" << options.size << "-" << i;
+        result->name = stream.str();
+        Sim::generate(options.size, options.size, i);
+    }
+    else {
+        const std::string& path = options.paths[i];
+        result->name = path.substr(path.find_last_of('/') + 1);
+        if (!Sim::load(path, &result->error)) {
+            return false;
+        }
+    }
+    if (Maze::MAX_WIDTH < Sim::width() || Maze::MAX_HEIGHT < Sim::height()) {
+        std::ostringstream stream;
+        stream << result->name << " is " << Sim::width() << " x " << Sim::height()
+               << ", but this build only supports mazes up to "
+               << static_cast<unsigned int>(Maze::MAX_WIDTH) << " x "
+               << static_cast<unsigned int>(Maze::MAX_HEIGHT)
+               << " (see MAX_MAZE_SIZE)";
+        result->error = stream.str();
+        return false;
+    }
+    return true;
+}
+
+// Runs the algorithm until the end of the first speed run
+void run(const Options& options, const CostParameters& parameters, Result* result) {
+    result->status = "stopped";
+    Sim::start(options.maxMoves);
+    Stats::clear();
+    try {
+        Algo algo;
+        algo.setCostParameters(parameters);
+        algo.solve();
+    }
+    catch (const Sim::Finished&) {
+        result->status = Sim::centerArrivals() < 2 ? "limit" : "ok";
+    }
+    catch (const Sim::Crashed&) {
+        result->status = "crash";
+    }
+    if (Sim::centerArrivals() == 0) {
+        result->status = "unsolved";
+    }
+    result->sample = Sim::atCenter();
+    result->moves = Sim::moves();
+    result->explorationTime = Sim::explorationTime();
+    result->speedRunTime = Sim::speedRunTime();
+}
+
+// The values of a cost parameter to sweep over
+struct Range {
+    int low;
+    int high;
+    int step;
+};
+
+// Parses either a single value, or LOW:HIGH:STEP
+bool parseRange(const char* text, int minimum, Range* range) {
+    char* end = NULL;
+    range->low = std::strtol(text, &end, 10);
+    range->high = range->low;
+    range->step = 1;
+    if (*end == ':') {
+        range->high = std::strtol(end + 1, &end, 10);
+        if (*end != ':') {
+            return false;
+        }
+        range->step = std::strtol(end + 1, &end, 10);
+    }
+    return (
+        *end == '\0' && minimum <= range->low && range->low <= range->high &&
+        range->high <= 256 && 0 < range->step
+    );
+}
+
+int count(const Range& range) {
+    return (range.high - range.low) / range.step + 1;
+}
+
+int value(const Range& range, int i) {
+    return range.low + i * range.step;
+}
+
+// How well one set of cost parameters did across all of the mazes
+struct Score {
+    CostParameters parameters;
+    int solved;
+    float speedRunTime;
+    float explorationTime;
+    long moves;
+};
+
+// Better scores solve more mazes, and then make faster speed runs
+bool isBetter(const Score& one, const Score& two) {
+    if (one.solved != two.solved) {
+        return one.solved > two.solved;
+    }
+    if (one.speedRunTime != two.speedRunTime) {
+        return one.speedRunTime < two.speedRunTime;
+    }
+    return one.explorationTime < two.explorationTime;
+}
+
+// Runs every set of parameters against every maze, in parallel, and prints
+// the sets from best to worst
+void sweep(
+    const Options& options,
+    const std::vector<CostParameters>& sets,
+    int numMazes,
+    int numThreads) {
+
+    // Each job is one set of parameters against one maze
+    int numJobs = static_cast<int>(sets.size()) * numMazes;
+    std::vector<Result> results(numJobs);
+    std::atomic<int> next(0);
+    NullBuffer nullBuffer;
+    std::streambuf* cerr = std::cerr.rdbuf(&nullBuffer);
+    bool started = runThreads(numThreads, [&options, &sets, &results, &next, numMazes, numJobs]() {
+        for (int i = next++; i < numJobs; i = next++) {
+            if (prepare(options, i % numMazes, &results[i])) {
+                run(options, sets[i / numMazes], &results[i]);
+            }
+        }
+    });
+    std::cerr.rdbuf(cerr);
+    if (!started) {
+        std::cerr << "ERROR - can't start " << numThreads << " threads" << std::endl;
+        return;
+    }
+
+    std::vector<Score> scores(sets.size());
+    for (size_t s = 0; s < sets.size(); s += 1) {
+        Score& score = scores[s];
+        score.parameters = sets[s];
+        score.solved = 0;
+        score.speedRunTime = 0;
+        score.explorationTime = 0;
+        score.moves = 0;
+        for (int m = 0; m < numMazes; m += 1) {
+            const Result& result = results[s * numMazes + m];
+            if (!result.error.empty()) {
+                if (s == 0) {
+                    std::cerr << "ERROR - " << result.error << std::endl;
+                }
+                continue;
+            }
+            if (std::strcmp(result.status, "ok") == 0) {
+                score.solved += 1;
+            }
+            score.speedRunTime += result.speedRunTime;
+            score.explorationTime += result.explorationTime;
+            score.moves += result.moves;
+        }
+    }
+    std::stable_sort(scores.begin(), scores.end(), isBetter);
+
+    std::cout << std::setw(6) << "rank"
+              << std::setw(7) << "turn"
+              << std::setw(10) << "straight"
+              << std::setw(7) << "floor"
+              << std::setw(8) << "solved"
+              << std::setw(10) << "speed_s"
+              << std::setw(11) << "explore_s"
+              << std::setw(9) << "moves" << std::endl;
+    for (size_t s = 0; s < scores.size(); s += 1) {
+        const Score& score = scores[s];
+        std::cout << std::setw(6) << s + 1
+                  << std::setw(7) << score.parameters.turnCost
+                  << std::setw(10) << score.parameters.straightAwayCost
+                  << std::setw(7) << score.parameters.minStraightAwayCost
+                  << std::setw(8) << score.solved
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(10) << score.speedRunTime
+                  << std::setw(11) << score.explorationTime
+                  << std::setw(9) << score.moves << std::endl;
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+
+    Options options;
+    options.numRandom = 10;
+    options.size = 16;
+    options.maxMoves = 10000;
+    int frontierRepetitions = 0;
+    int numThreads = 1;
+    bool sweeping = false;
+    int numSamples = 0;
+    const CostParameters defaults = Algo::getDefaultCostParameters();
+    int turnCost = defaults.turnCost;
+    int straightAwayCost = defaults.straightAwayCost;
+    int minStraightAwayCost = defaults.minStraightAwayCost;
+    Range turn = {turnCost, turnCost, 1};
+    Range straight = {straightAwayCost, straightAwayCost, 1};
+    Range floor = {minStraightAwayCost, minStraightAwayCost, 1};
+    for (int i = 1; i < argc; i += 1) {
+        if (std::strcmp(argv[i], "--random") == 0 && i + 1 < argc) {
+            options.numRandom = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            options.size = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--moves") == 0 && i + 1 < argc) {
+            options.maxMoves = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--frontier") == 0 && i + 1 < argc) {
+            frontierRepetitions = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--sweep") == 0) {
+            sweeping = true;
+        }
+        else if (std::strcmp(argv[i], "--sample") == 0 && i + 1 < argc) {
+            numSamples = std::atoi(argv[++i]);
+        }
+        else if (
+            (std::strcmp(argv[i], "--turn") == 0 ||
+             std::strcmp(argv[i], "--straight") == 0 ||
+             std::strcmp(argv[i], "--floor") == 0) && i + 1 < argc) {
+            bool isStraight = std::strcmp(argv[i], "--straight") == 0;
+            Range* range = (
+                isStraight ? &straight :
+                std::strcmp(argv[i], "--turn") == 0 ? &turn : &floor
+            );
+            if (!parseRange(argv[i + 1], isStraight ? 0 : 1, range)) {
+                std::cerr << "ERROR - bad range for " << argv[i] << ": "
+                          << argv[i + 1] << " (costs are from 1 to 256)"
+                          << std::endl;
+                return 1;
+            }
+            i += 1;
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            numThreads = std::atoi(argv[++i]);
+            if (numThreads <= 0) {
+                numThreads = std::max(1u, std::thread::hardware_concurrency());
+            }
+        }
+        else {
+            options.paths.push_back(argv[i]);
+        }
+    }
+    int numMazes = (
+        options.paths.empty() ? options.numRandom :
+        static_cast<int>(options.paths.size())
+    );
+
+    // The frontier comparison is a timing, so it runs on one thread only
+    if (frontierRepetitions) {
+        std::cout << std::left << std::setw(24) << "maze" << std::right
+                  << std::setw(10) << "heap_ns"
+                  << std::setw(10) << "bucket_ns"
+                  << std::setw(9) << "speedup"
+                  << "  status" << std::endl;
+        for (int i = 0; i < numMazes; i += 1) {
+            Result result;
+            if (!prepare(options, i, &result)) {
+                std::cerr << "ERROR - " << result.error << std::endl;
+                continue;
+            }
+            compareFrontiers(result.name, frontierRepetitions, false);
+            compareFrontiers(result.name + " A*", frontierRepetitions, true);
+        }
+        return 0;
+    }
+
+    // Either every combination of the ranges, or a random sample of them
+    if (sweeping) {
+        int numCombinations = count(turn) * count(straight) * count(floor);
+        std::vector<int> combinations(numCombinations);
+        for (int i = 0; i < numCombinations; i += 1) {
+            combinations[i] = i;
+        }
+        if (0 < numSamples && numSamples < numCombinations) {
+            std::mt19937 random(0);
+            std::shuffle(combinations.begin(), combinations.end(), random);
+            combinations.resize(numSamples);
+        }
+        std::vector<CostParameters> sets;
+        for (size_t i = 0; i < combinations.size(); i += 1) {
+            int combination = combinations[i];
+            CostParameters parameters;
+            parameters.turnCost = value(turn, combination % count(turn));
+            combination /= count(turn);
+            parameters.straightAwayCost = value(straight, combination % count(straight));
+            combination /= count(straight);
+            parameters.minStraightAwayCost = value(floor, combination);
+            sets.push_back(parameters);
+        }
+        sweep(options, sets, numMazes, numThreads);
+        return 0;
+    }
+
+    // Each thread has its own copy of all of the solver's state (see
+    // ThreadLocal.h), so the threads need only share the index of the next
+    // maze to solve. Whichever thread is free takes the next one, so that a
+    // few slow mazes can't hold up the rest.
+    std::vector<Result> results(numMazes);
+    std::atomic<int> next(0);
+    NullBuffer nullBuffer;
+    std::streambuf* cerr = std::cerr.rdbuf(&nullBuffer);
+    bool started = runThreads(numThreads, [&options, &defaults, &results, &next, numMazes]() {
+        for (int i = next++; i < numMazes; i = next++) {
+            if (prepare(options, i, &results[i])) {
+                run(options, defaults, &results[i]);
+            }
+        }
+    });
+    std::cerr.rdbuf(cerr);
+    if (!started) {
+        std::cerr << "ERROR - can't start " << numThreads << " threads" << std::endl;
+        return 1;
+    }
+
+    Sample total = Sample();
+    int totalRun = 0;
+    printHeader();
+    for (int i = 0; i < numMazes; i += 1) {
+        const Result& result = results[i];
+        if (!result.error.empty()) {
+            std::cerr << "ERROR - " << result.error << std::endl;
+            continue;
+        }
+        printRow(result.name, result.sample, result.moves, result.status);
+        add(&total, result.sample);
+        totalRun += result.moves;
+    }
+    printRow("total", total, totalRun, "");
+    return 0;
+}
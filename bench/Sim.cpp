@@ -0,0 +1,317 @@
+#include "Sim.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <utility>
+
+#include "Maze.h"
+#include "Stats.h"
+
+static const int DX[] = {0, 1, 0, -1};
+static const int DY[] = {1, 0, -1, 0};
+
+THREAD_LOCAL int Sim::m_width = 0;
+THREAD_LOCAL int Sim::m_height = 0;
+THREAD_LOCAL std::vector<unsigned char> Sim::m_walls;
+THREAD_LOCAL int Sim::m_x = 0;
+THREAD_LOCAL int Sim::m_y = 0;
+THREAD_LOCAL int Sim::m_d = 0;
+THREAD_LOCAL int Sim::m_moves = 0;
+THREAD_LOCAL int Sim::m_maxMoves = 0;
+THREAD_LOCAL int Sim::m_centerArrivals = 0;
+THREAD_LOCAL Sample Sim::m_atCenter = Sample();
+THREAD_LOCAL bool Sim::m_fromOrigin = true;
+THREAD_LOCAL MotionProfile Sim::m_profile;
+THREAD_LOCAL int Sim::m_straightAway = 0;
+THREAD_LOCAL int Sim::m_turns = 0;
+THREAD_LOCAL float Sim::m_time = 0;
+THREAD_LOCAL float Sim::m_departureTime = 0;
+THREAD_LOCAL float Sim::m_explorationTime = 0;
+THREAD_LOCAL float Sim::m_speedRunTime = 0;
+
+bool Sim::load(const std::string& path, std::string* error) {
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file) {
+        *error = "can't open " + path;
+        return false;
+    }
+    std::string contents(
+        (std::istreambuf_iterator<char>(file)),
+        std::istreambuf_iterator<char>()
+    );
+
+    // The .maz format is binary, and always square
+    if (path.size() >= 4 && path.compare(path.size() - 4, 4, ".maz") == 0) {
+        int size = 1;
+        while (size * size < static_cast<int>(contents.size())) {
+            size += 1;
+        }
+        if (size * size != static_cast<int>(contents.size()) || 255 < size) {
+            *error = path + " isn't a square .maz file";
+            return false;
+        }
+        m_width = size;
+        m_height = size;
+        m_walls.assign(contents.begin(), contents.end());
+        for (int i = 0; i < size * size; i += 1) {
+            m_walls[i] &= 15;
+        }
+        return true;
+    }
+
+    // Otherwise, assume the .num format, which doesn't state its size
+    std::vector<std::pair<std::pair<int, int>, int> > cells;
+    std::istringstream lines(contents);
+    int x, y, n, e, s, w;
+    m_width = 0;
+    m_height = 0;
+    while (lines >> x >> y >> n >> e >> s >> w) {
+        if (x < 0 || y < 0 || 255 <= x || 255 <= y) {
+            *error = path + " has a cell out of range";
+            return false;
+        }
+        cells.push_back(std::make_pair(
+            std::make_pair(x, y), n | (e << 1) | (s << 2) | (w << 3)
+        ));
+        m_width = std::max(m_width, x + 1);
+        m_height = std::max(m_height, y + 1);
+    }
+    if (cells.empty()) {
+        *error = path + " has no cells";
+        return false;
+    }
+    m_walls.assign(m_width * m_height, 15);
+    for (size_t i = 0; i < cells.size(); i += 1) {
+        m_walls[cells[i].first.first * m_height + cells[i].first.second] =
+            cells[i].second;
+    }
+    return true;
+}
+
+void Sim::generate(int width, int height, unsigned int seed) {
+
+    // Carve a spanning tree with a randomized depth-first search
+    std::mt19937 random(seed);
+    m_width = width;
+    m_height = height;
+    m_walls.assign(width * height, 15);
+    std::vector<bool> visited(width * height, false);
+    std::vector<std::pair<int, int> > stack;
+    stack.push_back(std::make_pair(0, 0));
+    visited[0] = true;
+    while (!stack.empty()) {
+        int x = stack.back().first;
+        int y = stack.back().second;
+        int options[4];
+        int numOptions = 0;
+        for (int d = 0; d < 4; d += 1) {
+            int nx = x + DX[d];
+            int ny = y + DY[d];
+            if (0 <= nx && nx < width && 0 <= ny && ny < height &&
+                !visited[nx * height + ny]) {
+                options[numOptions] = d;
+                numOptions += 1;
+            }
+        }
+        if (numOptions == 0) {
+            stack.pop_back();
+            continue;
+        }
+        int d = options[random() % numOptions];
+        clearWall(x, y, d);
+        visited[(x + DX[d]) * height + y + DY[d]] = true;
+        stack.push_back(std::make_pair(x + DX[d], y + DY[d]));
+    }
+
+    // Knock down about one in ten of the remaining interior walls
+    for (int x = 0; x < width; x += 1) {
+        for (int y = 0; y < height; y += 1) {
+            for (int d = 0; d < 2; d += 1) {
+                int nx = x + DX[d];
+                int ny = y + DY[d];
+                if (nx < width && ny < height && isWall(x, y, d) &&
+                    random() % 10 == 0) {
+                    clearWall(x, y, d);
+                }
+            }
+        }
+    }
+
+    // Open up the center, with the classic single entrance left as is
+    int cx = (width - 1) / 2;
+    int cy = (height - 1) / 2;
+    if (cx + 1 < width && cy + 1 < height) {
+        clearWall(cx, cy, 0);
+        clearWall(cx, cy, 1);
+        clearWall(cx + 1, cy + 1, 2);
+        clearWall(cx + 1, cy + 1, 3);
+    }
+}
+
+Sample Sample::take() {
+    Sample sample;
+    sample.steps = Stats::total(Stats::STEPS);
+    sample.cellsMoved = Stats::total(Stats::CELLS_MOVED);
+    sample.plans = Stats::total(Stats::PLANS);
+    sample.planNanoseconds = Stats::total(Stats::PLAN_NS);
+    sample.heapPushes = Stats::total(Stats::HEAP_PUSHES);
+    sample.heapPops = Stats::total(Stats::HEAP_POPS);
+    sample.heapUpdates = Stats::total(Stats::HEAP_UPDATES);
+    sample.relaxations = Stats::total(Stats::RELAXATIONS);
+    sample.expansions = Stats::total(Stats::EXPANSIONS);
+    return sample;
+}
+
+void Sim::start(int maxMoves) {
+    m_x = 0;
+    m_y = 0;
+    m_d = 0;
+    m_moves = 0;
+    m_maxMoves = maxMoves;
+    m_centerArrivals = 0;
+    m_atCenter = Sample();
+    m_fromOrigin = true;
+    m_straightAway = 0;
+    m_turns = 0;
+    m_time = 0;
+    m_departureTime = 0;
+    m_explorationTime = 0;
+    m_speedRunTime = 0;
+}
+
+void Sim::reveal() {
+    Maze::clear();
+    Maze::setSize(m_width, m_height);
+    for (int x = 0; x < m_width; x += 1) {
+        for (int y = 0; y < m_height; y += 1) {
+            for (int direction = 0; direction < 4; direction += 1) {
+                Maze::setWall(x, y, direction, isWall(x, y, direction));
+            }
+        }
+    }
+}
+
+int Sim::width() {
+    return m_width;
+}
+
+int Sim::height() {
+    return m_height;
+}
+
+bool Sim::wall(int turn) {
+    return isWall(m_x, m_y, (m_d + turn) % 4);
+}
+
+void Sim::moveForward(int distance) {
+    for (int i = 0; i < distance; i += 1) {
+        if (isWall(m_x, m_y, m_d)) {
+            throw Crashed();
+        }
+        finishTurn();
+        m_x += DX[m_d];
+        m_y += DY[m_d];
+        m_moves += 1;
+        m_straightAway += 1;
+
+        // Count arrivals at the center, but only after starting from (or
+        // returning to) the origin, since the way back may skirt the center
+        if (m_x == 0 && m_y == 0) {
+            finishStraightAway();
+            m_fromOrigin = true;
+            m_departureTime = m_time;
+        }
+        if (m_fromOrigin && inCenter(m_x, m_y)) {
+            finishStraightAway();
+            m_fromOrigin = false;
+            m_centerArrivals += 1;
+            if (m_centerArrivals == 1) {
+                m_atCenter = Sample::take();
+                m_explorationTime = m_time;
+            }
+            if (m_centerArrivals == 2) {
+                m_speedRunTime = m_time - m_departureTime;
+                throw Finished();
+            }
+        }
+        if (m_maxMoves <= m_moves) {
+            throw Finished();
+        }
+    }
+}
+
+void Sim::turn(int turns) {
+    finishStraightAway();
+    m_turns += turns;
+    m_d = (m_d + turns) % 4;
+}
+
+int Sim::moves() {
+    return m_moves;
+}
+
+int Sim::centerArrivals() {
+    return m_centerArrivals;
+}
+
+const Sample& Sim::atCenter() {
+    return m_atCenter;
+}
+
+void Sim::setProfile(const MotionProfile& profile) {
+    m_profile = profile;
+}
+
+float Sim::explorationTime() {
+    return m_explorationTime;
+}
+
+float Sim::speedRunTime() {
+    return m_speedRunTime;
+}
+
+bool Sim::isWall(int x, int y, int direction) {
+    // Files without perimeter walls still mustn't let the mouse escape
+    int nx = x + DX[direction];
+    int ny = y + DY[direction];
+    if (nx < 0 || m_width <= nx || ny < 0 || m_height <= ny) {
+        return true;
+    }
+    return (m_walls[x * m_height + y] >> direction) & 1;
+}
+
+void Sim::clearWall(int x, int y, int direction) {
+    m_walls[x * m_height + y] &= ~(1 << direction);
+    int nx = x + DX[direction];
+    int ny = y + DY[direction];
+    if (0 <= nx && nx < m_width && 0 <= ny && ny < m_height) {
+        m_walls[nx * m_height + ny] &= ~(1 << ((direction + 2) % 4));
+    }
+}
+
+bool Sim::inCenter(int x, int y) {
+    return (m_width - 1) / 2 <= x && x <= m_width / 2 &&
+           (m_height - 1) / 2 <= y && y <= m_height / 2;
+}
+
+void Sim::finishStraightAway() {
+    if (0 < m_straightAway) {
+        m_time += m_profile.runTime(m_straightAway, false);
+        m_straightAway = 0;
+    }
+}
+
+void Sim::finishTurn() {
+    // A quarter turn is taken on the move, but turning around means
+    // stopping and pivoting in place
+    if (m_turns % 2 == 1) {
+        m_time += m_profile.turnTime[2];
+    }
+    else if (m_turns % 4 == 2) {
+        m_time += 2 * m_profile.pivotTime;
+    }
+    m_turns = 0;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "MotionProfile.h"
+#include "ThreadLocal.h"
+
+// A snapshot of the Stats counters
+struct Sample {
+    unsigned long steps;
+    unsigned long cellsMoved;
+    unsigned long plans;
+    unsigned long planNanoseconds;
+    unsigned long heapPushes;
+    unsigned long heapPops;
+    unsigned long heapUpdates;
+    unsigned long relaxations;
+    unsigned long expansions;
+
+    static Sample take();
+};
+
+class Sim {
+
+    // The Sim class is an in-memory stand-in for the mms simulator. It holds
+    // an actual maze and the actual pose of the mouse, and it answers the
+    // API's wall queries and carries out its movements directly, so that the
+    // algorithm can be run (and timed) without any inter-process protocol.
+
+public:
+
+    // Thrown out of the API (and thus out of Algo::solve()) to end a run
+    struct Finished {};
+    struct Crashed {};
+
+    // Loads a maze from a file, either in the classic binary .maz format (one
+    // byte per cell, column by column, with N = 1, E = 2, S = 4, W = 8) or in
+    // the text .num format (one "x y N E S W" line per cell). Returns false,
+    // with an error message, if the file can't be loaded.
+    static bool load(const std::string& path, std::string* error);
+
+    // Generates a random maze with a few loops, deterministically from a seed
+    static void generate(int width, int height, unsigned int seed);
+
+    // Puts the mouse back at the origin, facing north, and ends the run
+    // after the given number of moves, or once the mouse has reached the
+    // center for the second time (i.e., at the end of the first speed run)
+    static void start(int maxMoves);
+
+    // Copies the whole maze into the Maze class, as if every wall were known
+    static void reveal();
+
+    static int width();
+    static int height();
+
+    // Walls relative to the mouse (0 = front, 1 = right, 3 = left)
+    static bool wall(int turn);
+    static void moveForward(int distance);
+    static void turn(int turns);
+
+    // The number of moves made so far, and the number of arrivals at the
+    // center, along with the planner's Stats as of the first arrival
+    static int moves();
+    static int centerArrivals();
+    static const Sample& atCenter();
+
+    // The time that the mouse would have taken (according to the given
+    // MotionProfile, and stopping only to turn around) to first reach the
+    // center, and to make the speed run from the origin back to the center,
+    // or zero if it hasn't yet
+    static void setProfile(const MotionProfile& profile);
+    static float explorationTime();
+    static float speedRunTime();
+
+private:
+
+    static THREAD_LOCAL int m_width;
+    static THREAD_LOCAL int m_height;
+
+    // The walls of each cell, indexed by x * height + y, as NESW bits
+    static THREAD_LOCAL std::vector<unsigned char> m_walls;
+
+    static THREAD_LOCAL int m_x;
+    static THREAD_LOCAL int m_y;
+    static THREAD_LOCAL int m_d;
+    static THREAD_LOCAL int m_moves;
+    static THREAD_LOCAL int m_maxMoves;
+    static THREAD_LOCAL int m_centerArrivals;
+    static THREAD_LOCAL Sample m_atCenter;
+    static THREAD_LOCAL bool m_fromOrigin;
+
+    static THREAD_LOCAL MotionProfile m_profile;
+    static THREAD_LOCAL int m_straightAway; // Cells since the last turn
+    static THREAD_LOCAL int m_turns; // Quarter turns since the last move
+    static THREAD_LOCAL float m_time;
+    static THREAD_LOCAL float m_departureTime; // From the origin
+    static THREAD_LOCAL float m_explorationTime;
+    static THREAD_LOCAL float m_speedRunTime;
+
+    static bool isWall(int x, int y, int direction);
+    static void clearWall(int x, int y, int direction);
+    static bool inCenter(int x, int y);
+    static void finishStraightAway();
+    static void finishTurn();
+
+};
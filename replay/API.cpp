@@ -0,0 +1,127 @@
+#include "API.h"
+
+#include "Player.h"
+#include "Stats.h"
+#include "Trace.h"
+
+// An implementation of the API that is backed by a recorded Trace rather
+// than by the mms simulator, which the replayer links in place of the one in
+// src/. Visualization commands are simply dropped, as they were when the
+// trace was recorded.
+
+THREAD_LOCAL bool API::m_buffered = false;
+THREAD_LOCAL int API::m_flushCount = 0;
+
+int API::mazeWidth() {
+    Stats::count(Stats::API_SIZE_QUERIES);
+    return Player::nextValue(Trace::SIZE);
+}
+
+int API::mazeHeight() {
+    Stats::count(Stats::API_SIZE_QUERIES);
+    return Player::nextValue(Trace::SIZE);
+}
+
+bool API::wallFront() {
+    Stats::count(Stats::API_WALL_QUERIES);
+    return Player::wall(0);
+}
+
+bool API::wallRight() {
+    Stats::count(Stats::API_WALL_QUERIES);
+    return Player::wall(1);
+}
+
+bool API::wallLeft() {
+    Stats::count(Stats::API_WALL_QUERIES);
+    return Player::wall(3);
+}
+
+int API::readWalls() {
+    Stats::count(Stats::API_WALL_QUERIES);
+    return Player::next(Trace::WALLS);
+}
+
+void API::moveForward() {
+    Stats::count(Stats::API_MOVES);
+    Player::moveForward(1);
+}
+
+void API::moveForward(int distance) {
+    Stats::count(Stats::API_MOVES);
+    Player::moveForward(distance);
+}
+
+void API::startMoveForward() {
+    Stats::count(Stats::API_MOVES);
+    Player::moveForward(1);
+}
+
+void API::finishMove() {
+}
+
+void API::turnRight() {
+    Stats::count(Stats::API_TURNS);
+    Player::next(Trace::TURN_RIGHT);
+}
+
+void API::turnLeft() {
+    Stats::count(Stats::API_TURNS);
+    Player::next(Trace::TURN_LEFT);
+}
+
+void API::setWall(int x, int y, char direction) {
+}
+
+void API::clearWall(int x, int y, char direction) {
+}
+
+void API::setColor(int x, int y, char color) {
+}
+
+void API::clearColor(int x, int y) {
+}
+
+void API::clearAllColor() {
+}
+
+void API::setText(int x, int y, const std::string& text) {
+}
+
+void API::clearText(int x, int y) {
+}
+
+void API::clearAllText() {
+}
+
+bool API::wasReset() {
+    Stats::count(Stats::API_RESET_QUERIES);
+    return Player::next(Trace::RESET) == 1;
+}
+
+void API::ackReset() {
+    Stats::count(Stats::API_RESET_QUERIES);
+    Player::next(Trace::ACK_RESET);
+}
+
+void API::setBuffered(bool buffered) {
+    m_buffered = buffered;
+}
+
+int API::getFlushCount() {
+    return m_flushCount;
+}
+
+void API::resetFlushCount() {
+    m_flushCount = 0;
+}
+
+bool API::useBinaryProtocol(const char* socketPath) {
+    // There's no protocol at all in a replay
+    return false;
+}
+
+bool API::recordTrace(const char* path) {
+    // Nor anything new to record
+    return false;
+}
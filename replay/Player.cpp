@@ -0,0 +1,120 @@
+#include "Player.h"
+
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#include "Trace.h"
+
+THREAD_LOCAL std::vector<byte> Player::m_events;
+THREAD_LOCAL int Player::m_position = 0;
+THREAD_LOCAL std::string Player::m_divergence;
+
+static const char* NAMES[] = {
+    "size", "walls", "wall", "reset", "ackReset",
+    "moveForward", "turnRight", "turnLeft"
+};
+
+static const char* getName(byte kind) {
+    return kind <= Trace::TURN_LEFT ? NAMES[kind] : "an unknown event";
+}
+
+bool Player::load(const std::string& path, std::string* error) {
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if (!file) {
+        *error = "can't open " + path;
+        return false;
+    }
+    std::string contents(
+        (std::istreambuf_iterator<char>(file)),
+        std::istreambuf_iterator<char>()
+    );
+    if (contents.size() < Trace::HEADER_SIZE ||
+        contents[0] != 'M' ||
+        contents[1] != 'T' ||
+        contents[2] != Trace::VERSION) {
+        *error = path + " isn't a version " +
+            std::to_string(Trace::VERSION) + " trace";
+        return false;
+    }
+    m_events.assign(contents.begin() + Trace::HEADER_SIZE, contents.end());
+    m_position = 0;
+    return true;
+}
+
+void Player::rewind() {
+    m_position = 0;
+    m_divergence.clear();
+}
+
+byte Player::next(byte kind) {
+    if (m_position == size()) {
+        throw Finished();
+    }
+    byte event = m_events[m_position];
+    if (Trace::kind(event) != kind) {
+        diverge(getName(kind));
+    }
+    m_position += 1;
+    return Trace::argument(event);
+}
+
+byte Player::nextValue(byte kind) {
+    next(kind);
+    if (m_position == size()) {
+        throw Finished();
+    }
+    byte value = m_events[m_position];
+    m_position += 1;
+    return value;
+}
+
+bool Player::wall(byte turn) {
+    int position = m_position;
+    byte argument = next(Trace::WALL);
+    if ((argument & 3) != turn) {
+        m_position = position;
+        diverge("wall " + std::to_string(turn));
+    }
+    return (argument >> 2) & 1;
+}
+
+void Player::moveForward(int distance) {
+    // Rewind to the event itself, rather than the value after it, if any
+    int position = m_position;
+    int expected = next(Trace::MOVE_FORWARD);
+    if (expected == 0) {
+        m_position = position;
+        expected = nextValue(Trace::MOVE_FORWARD);
+    }
+    if (expected != distance) {
+        m_position = position;
+        diverge("moveForward " + std::to_string(distance));
+    }
+}
+
+int Player::position() {
+    return m_position;
+}
+
+int Player::size() {
+    return m_events.size();
+}
+
+const std::string& Player::divergence() {
+    return m_divergence;
+}
+
+void Player::diverge(const std::string& actual) {
+    byte event = m_events[m_position];
+    std::ostringstream stream;
+    byte kind = Trace::kind(event);
+    stream << "at byte " << Trace::HEADER_SIZE + m_position
+           << ", the trace has " << getName(kind);
+    if (kind == Trace::WALLS || kind == Trace::WALL || kind == Trace::MOVE_FORWARD) {
+        stream << " " << static_cast<unsigned int>(Trace::argument(event));
+    }
+    stream << ", but the mouse did " << actual;
+    m_divergence = stream.str();
+    throw Diverged();
+}
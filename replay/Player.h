@@ -0,0 +1,57 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Byte.h"
+#include "ThreadLocal.h"
+
+class Player {
+
+    // The Player class plays a Trace back to the mouse, in place of the mms
+    // simulator: each of the API's queries is answered with the next event of
+    // the trace, and each of its moves is checked against the next event, so
+    // that a change to the algorithm that makes it behave differently is
+    // caught at the first move (or query) where it does so.
+
+public:
+
+    // Thrown out of the API (and thus out of Algo::solve()) to end a replay
+    struct Finished {};
+    struct Diverged {};
+
+    // Loads a trace from a file, or returns false, with an error message, if
+    // it isn't a trace of this version
+    static bool load(const std::string& path, std::string* error);
+
+    // Starts the replay over, from the first event
+    static void rewind();
+
+    // The argument of the next event, which must be of the given kind, and
+    // for the value events, the value that follows it
+    static byte next(byte kind);
+    static byte nextValue(byte kind);
+
+    // The answer of the next event, which must be about the wall the given
+    // number of right turns away from the front
+    static bool wall(byte turn);
+
+    // Checks that the next event is a move of the given distance
+    static void moveForward(int distance);
+
+    // The number of bytes of events replayed so far, and in total
+    static int position();
+    static int size();
+
+    // What the mouse did (or asked) instead of the next event, if diverged
+    static const std::string& divergence();
+
+private:
+
+    static THREAD_LOCAL std::vector<byte> m_events;
+    static THREAD_LOCAL int m_position;
+    static THREAD_LOCAL std::string m_divergence;
+
+    static void diverge(const std::string& actual);
+
+};
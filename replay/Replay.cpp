@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "Algo.h"
+#include "Player.h"
+#include "Stats.h"
+
+// Replays a recorded Trace (see Algo::shouldRecordTrace()) through the
+// algorithm, in process and with no I/O, and reports how long it took and
+// the planning work done. Usage:
+//
+//     mackreplay [--repeat R] trace
+//
+// The trace is replayed R times (1 by default), and the times are averaged
+// over them, e.g., for profiling generatePath and followPath. If the mouse
+// does anything other than what the trace says it did, the replay stops
+// there and exits with status 1, so that traces double as regression tests.
+
+namespace {
+
+// Discards everything written to it, so that the algorithm's logging
+// doesn't get timed along with it
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) {
+        return c;
+    }
+};
+
+// Runs the algorithm until the end of the trace, and returns whether it
+// did exactly what the trace says
+bool replay() {
+    Player::rewind();
+    Stats::clear();
+    try {
+        Algo algo;
+        algo.solve();
+    }
+    catch (const Player::Finished&) {
+        return true;
+    }
+    catch (const Player::Diverged&) {
+        return false;
+    }
+
+    // The mouse stopped on its own, which it should have done in the trace
+    return Player::position() == Player::size();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int repetitions = 1;
+    const char* path = NULL;
+    for (int i = 1; i < argc; i += 1) {
+        if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repetitions = std::max(1, std::atoi(argv[++i]));
+        }
+        else {
+            path = argv[i];
+        }
+    }
+    if (path == NULL) {
+        std::cerr << "Usage: " << argv[0] << " [--repeat R] trace" << std::endl;
+        return 1;
+    }
+    std::string error;
+    if (!Player::load(path, &error)) {
+        std::cerr << "ERROR - " << error << std::endl;
+        return 1;
+    }
+
+    NullBuffer nullBuffer;
+    std::streambuf* cerr = std::cerr.rdbuf(&nullBuffer);
+    bool faithful = true;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repetitions && faithful; r += 1) {
+        faithful = replay();
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    std::cerr.rdbuf(cerr);
+    if (!faithful) {
+        std::cerr << "DIVERGED - "
+                  << (Player::divergence().empty() ?
+                      "the mouse stopped before the end of the trace" :
+                      Player::divergence())
+                  << std::endl;
+        return 1;
+    }
+
+    // Stats are those of the last replay, which was just like the others
+    long long nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        end - start
+    ).count();
+    std::cout << std::setw(9) << "bytes"
+              << std::setw(7) << "steps"
+              << std::setw(7) << "plans"
+              << std::setw(10) << "plan_us"
+              << std::setw(10) << "step_us"
+              << std::setw(10) << "total_us"
+              << std::setw(9) << "repeats" << std::endl;
+    std::cout << std::setw(9) << Player::size()
+              << std::setw(7) << Stats::total(Stats::STEPS)
+              << std::setw(7) << Stats::total(Stats::PLANS)
+              << std::setw(10) << Stats::total(Stats::PLAN_NS) / 1000
+              << std::setw(10) << Stats::total(Stats::STEP_NS) / 1000
+              << std::setw(10) << nanoseconds / repetitions / 1000
+              << std::setw(9) << repetitions << std::endl;
+    return 0;
+}
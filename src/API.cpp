@@ -1,47 +1,186 @@
 #include "API.h"
 
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "Protocol.h"
+#include "Stats.h"
+#include "Trace.h"
+
+THREAD_LOCAL bool API::m_buffered = false;
+THREAD_LOCAL int API::m_flushCount = 0;
+THREAD_LOCAL bool API::m_binary = false;
+THREAD_LOCAL int API::m_socket = -1;
+THREAD_LOCAL char API::m_frames[API::FRAME_BUFFER_SIZE];
+THREAD_LOCAL twobyte API::m_numFrameBytes = 0;
+
 int API::mazeWidth() {
-    std::cout << "mazeWidth" << std::endl;
-    std::string response;
-    std::cin >> response;
-    return atoi(response.c_str());
+    Stats::count(Stats::API_SIZE_QUERIES);
+    int size;
+    if (m_binary) {
+        size = query(Protocol::MAZE_WIDTH);
+    }
+    else {
+        std::cout << "mazeWidth";
+        endQuery();
+        size = atoi(readResponse().c_str());
+    }
+    Trace::recordValue(Trace::SIZE, 0, size);
+    return size;
 }
 
 int API::mazeHeight() {
-    std::cout << "mazeHeight" << std::endl;
-    std::string response;
-    std::cin >> response;
-    return atoi(response.c_str());
+    Stats::count(Stats::API_SIZE_QUERIES);
+    int size;
+    if (m_binary) {
+        size = query(Protocol::MAZE_HEIGHT);
+    }
+    else {
+        std::cout << "mazeHeight";
+        endQuery();
+        size = atoi(readResponse().c_str());
+    }
+    Trace::recordValue(Trace::SIZE, 0, size);
+    return size;
 }
 
 bool API::wallFront() {
-    std::cout << "wallFront" << std::endl;
-    std::string response;
-    std::cin >> response;
-    return response == "true";
+    Stats::count(Stats::API_WALL_QUERIES);
+    bool wall;
+    if (m_binary) {
+        wall = query(Protocol::WALL_FRONT) == 1;
+    }
+    else {
+        std::cout << "wallFront";
+        endQuery();
+        wall = readResponse() == "true";
+    }
+    Trace::record(Trace::WALL, 0 | (wall ? 4 : 0));
+    return wall;
 }
 
 bool API::wallRight() {
-    std::cout << "wallRight" << std::endl;
-    std::string response;
-    std::cin >> response;
-    return response == "true";
+    Stats::count(Stats::API_WALL_QUERIES);
+    bool wall;
+    if (m_binary) {
+        wall = query(Protocol::WALL_RIGHT) == 1;
+    }
+    else {
+        std::cout << "wallRight";
+        endQuery();
+        wall = readResponse() == "true";
+    }
+    Trace::record(Trace::WALL, 1 | (wall ? 4 : 0));
+    return wall;
 }
 
 bool API::wallLeft() {
-    std::cout << "wallLeft" << std::endl;
-    std::string response;
-    std::cin >> response;
-    return response == "true";
+    Stats::count(Stats::API_WALL_QUERIES);
+    bool wall;
+    if (m_binary) {
+        wall = query(Protocol::WALL_LEFT) == 1;
+    }
+    else {
+        std::cout << "wallLeft";
+        endQuery();
+        wall = readResponse() == "true";
+    }
+    Trace::record(Trace::WALL, 3 | (wall ? 4 : 0));
+    return wall;
+}
+
+int API::readWalls() {
+    Stats::count(Stats::API_WALL_QUERIES);
+    int walls = 0;
+    if (m_binary) {
+        walls = query(Protocol::READ_WALLS);
+        walls = walls < 0 ? 0 : walls;
+    }
+    else {
+        std::cout << "wallFront\nwallRight\nwallLeft";
+        endQuery();
+        if (readResponse() == "true") {
+            walls |= 1 << 0;
+        }
+        if (readResponse() == "true") {
+            walls |= 1 << 1;
+        }
+        if (readResponse() == "true") {
+            walls |= 1 << 3;
+        }
+    }
+    Trace::record(Trace::WALLS, walls);
+    return walls;
 }
 
 void API::moveForward() {
-    std::cout << "moveForward" << std::endl;
-    std::string response;
-    std::cin >> response;
+    Stats::count(Stats::API_MOVES);
+    Trace::recordMove(1);
+    if (m_binary) {
+        beginFrame(Protocol::MOVE_FORWARD);
+        put(1);
+        flush();
+        finishMove();
+        return;
+    }
+    std::cout << "moveForward";
+    endQuery();
+    std::string response = readResponse();
+    if (response != "ack") {
+        std::cerr << response << std::endl;
+        throw;
+    }
+}
+
+void API::moveForward(int distance) {
+    Stats::count(Stats::API_MOVES);
+    Trace::recordMove(distance);
+    if (m_binary) {
+        beginFrame(Protocol::MOVE_FORWARD);
+        put(distance);
+        flush();
+        finishMove();
+        return;
+    }
+    std::cout << "moveForward " << distance;
+    endQuery();
+    std::string response = readResponse();
+    if (response != "ack") {
+        std::cerr << response << std::endl;
+        throw;
+    }
+}
+
+void API::startMoveForward() {
+    Stats::count(Stats::API_MOVES);
+    Trace::recordMove(1);
+    if (m_binary) {
+        beginFrame(Protocol::MOVE_FORWARD);
+        put(1);
+        flush();
+        return;
+    }
+    std::cout << "moveForward";
+    endQuery();
+}
+
+void API::finishMove() {
+    if (m_binary) {
+        int response = readReply();
+        if (response != 0) {
+            std::cerr << "crash (" << response << ")" << std::endl;
+            throw;
+        }
+        return;
+    }
+    std::string response = readResponse();
     if (response != "ack") {
         std::cerr << response << std::endl;
         throw;
@@ -49,58 +188,309 @@ void API::moveForward() {
 }
 
 void API::turnRight() {
-    std::cout << "turnRight" << std::endl;
-    std::string ack;
-    std::cin >> ack;
+    Stats::count(Stats::API_TURNS);
+    Trace::record(Trace::TURN_RIGHT);
+    if (m_binary) {
+        query(Protocol::TURN_RIGHT);
+        return;
+    }
+    std::cout << "turnRight";
+    endQuery();
+    readResponse();
 }
 
 void API::turnLeft() {
-    std::cout << "turnLeft" << std::endl;
-    std::string ack;
-    std::cin >> ack;
+    Stats::count(Stats::API_TURNS);
+    Trace::record(Trace::TURN_LEFT);
+    if (m_binary) {
+        query(Protocol::TURN_LEFT);
+        return;
+    }
+    std::cout << "turnLeft";
+    endQuery();
+    readResponse();
 }
 
 void API::setWall(int x, int y, char direction) {
-    std::cout << "setWall " << x << " " << y << " " << direction << std::endl;
+    if (m_binary) {
+        beginFrame(Protocol::SET_WALL);
+        put(x);
+        put(y);
+        put(direction);
+        endCommand();
+        return;
+    }
+    std::cout << "setWall " << x << " " << y << " " << direction;
+    endCommand();
 }
 
 void API::clearWall(int x, int y, char direction) {
-    std::cout << "clearWall " << x << " " << y << " " << direction << std::endl;
+    if (m_binary) {
+        beginFrame(Protocol::CLEAR_WALL);
+        put(x);
+        put(y);
+        put(direction);
+        endCommand();
+        return;
+    }
+    std::cout << "clearWall " << x << " " << y << " " << direction;
+    endCommand();
 }
 
 void API::setColor(int x, int y, char color) {
-    std::cout << "setColor " << x << " " << y << " " << color << std::endl;
+    if (m_binary) {
+        beginFrame(Protocol::SET_COLOR);
+        put(x);
+        put(y);
+        put(color);
+        endCommand();
+        return;
+    }
+    std::cout << "setColor " << x << " " << y << " " << color;
+    endCommand();
 }
 
 void API::clearColor(int x, int y) {
-    std::cout << "clearColor " << x << " " << y << std::endl;
+    if (m_binary) {
+        beginFrame(Protocol::CLEAR_COLOR);
+        put(x);
+        put(y);
+        endCommand();
+        return;
+    }
+    std::cout << "clearColor " << x << " " << y;
+    endCommand();
 }
 
 void API::clearAllColor() {
-    std::cout << "clearAllColor" << std::endl;
+    if (m_binary) {
+        beginFrame(Protocol::CLEAR_ALL_COLOR);
+        endCommand();
+        return;
+    }
+    std::cout << "clearAllColor";
+    endCommand();
 }
 
 void API::setText(int x, int y, const std::string& text) {
-    std::cout << "setText " << x << " " << y << " " << text << std::endl;
+    if (m_binary) {
+        byte length = text.size() < 255 ? text.size() : 255;
+        beginFrame(Protocol::SET_TEXT);
+        put(x);
+        put(y);
+        put(length);
+        for (byte i = 0; i < length; i += 1) {
+            put(text[i]);
+        }
+        endCommand();
+        return;
+    }
+    std::cout << "setText " << x << " " << y << " " << text;
+    endCommand();
 }
 
 void API::clearText(int x, int y) {
-    std::cout << "clearText " << x << " " << y << std::endl;
+    if (m_binary) {
+        beginFrame(Protocol::CLEAR_TEXT);
+        put(x);
+        put(y);
+        endCommand();
+        return;
+    }
+    std::cout << "clearText " << x << " " << y;
+    endCommand();
 }
 
 void API::clearAllText() {
-    std::cout << "clearAllText" << std::endl;
+    if (m_binary) {
+        beginFrame(Protocol::CLEAR_ALL_TEXT);
+        endCommand();
+        return;
+    }
+    std::cout << "clearAllText";
+    endCommand();
 }
 
 bool API::wasReset() {
-    std::cout << "wasReset" << std::endl;
+    Stats::count(Stats::API_RESET_QUERIES);
+    bool reset;
+    if (m_binary) {
+        reset = query(Protocol::WAS_RESET) == 1;
+    }
+    else {
+        std::cout << "wasReset";
+        endQuery();
+        reset = readResponse() == "true";
+    }
+    Trace::record(Trace::RESET, reset ? 1 : 0);
+    Trace::flush();
+    return reset;
+}
+
+void API::ackReset() {
+    Stats::count(Stats::API_RESET_QUERIES);
+    Trace::record(Trace::ACK_RESET);
+    if (m_binary) {
+        query(Protocol::ACK_RESET);
+        return;
+    }
+    std::cout << "ackReset";
+    endQuery();
+    readResponse();
+}
+
+void API::setBuffered(bool buffered) {
+    m_buffered = buffered;
+    flush();
+}
+
+int API::getFlushCount() {
+    return m_flushCount;
+}
+
+void API::resetFlushCount() {
+    m_flushCount = 0;
+}
+
+bool API::recordTrace(const char* path) {
+    return Trace::start(path);
+}
+
+bool API::useBinaryProtocol(const char* socketPath) {
+    flush();
+    if (socketPath != NULL) {
+#ifdef _WIN32
+        return false;
+#else
+        sockaddr_un address;
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (sizeof(address.sun_path) <= std::strlen(socketPath)) {
+            return false;
+        }
+        std::strcpy(address.sun_path, socketPath);
+        m_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (m_socket < 0) {
+            return false;
+        }
+        if (connect(m_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            close(m_socket);
+            m_socket = -1;
+            return false;
+        }
+#endif
+    }
+
+    // The request and the reply are both text lines
+    write(Protocol::REQUEST, std::strlen(Protocol::REQUEST));
+    write("\n", 1);
+    char reply[16];
+    int length = 0;
+    for (int c = readByte(); 0 <= c && c != '\n'; c = readByte()) {
+        if (c != '\r' && length < static_cast<int>(sizeof(reply)) - 1) {
+            reply[length] = c;
+            length += 1;
+        }
+    }
+    reply[length] = '\0';
+    m_binary = std::strcmp(reply, Protocol::ACCEPT) == 0;
+#ifndef _WIN32
+    if (!m_binary && 0 <= m_socket) {
+        close(m_socket);
+        m_socket = -1;
+    }
+#endif
+    return m_binary;
+}
+
+void API::endCommand() {
+    Stats::count(Stats::API_COMMANDS);
+    if (!m_binary) {
+        std::cout << '\n';
+    }
+    if (!m_buffered) {
+        flush();
+    }
+}
+
+void API::endQuery() {
+    // Queries always flush, since we're about to block waiting for the
+    // response; this also sends any commands that were buffered before it
+    std::cout << '\n';
+    flush();
+}
+
+void API::flush() {
+    Stats::count(Stats::API_FLUSHES);
+    if (m_binary) {
+        write(m_frames, m_numFrameBytes);
+        m_numFrameBytes = 0;
+    }
+    else {
+        std::cout.flush();
+    }
+    m_flushCount += 1;
+}
+
+std::string API::readResponse() {
+    Stats::startTimer(Stats::WAIT_NS);
     std::string response;
     std::cin >> response;
-    return response == "true";
+    Stats::stopTimer(Stats::WAIT_NS);
+    return response;
 }
 
-void API::ackReset() {
-    std::cout << "ackReset" << std::endl;
-    std::string ack;
-    std::cin >> ack;
+void API::beginFrame(byte opcode) {
+    // Make room for the whole command, so that frames are never split
+    if (FRAME_BUFFER_SIZE < m_numFrameBytes + Protocol::MAX_FRAME) {
+        flush();
+    }
+    put(opcode);
+}
+
+void API::put(byte value) {
+    m_frames[m_numFrameBytes] = value;
+    m_numFrameBytes += 1;
+}
+
+int API::query(byte opcode) {
+    beginFrame(opcode);
+    flush();
+    return readReply();
+}
+
+int API::readReply() {
+    Stats::startTimer(Stats::WAIT_NS);
+    int reply = readByte();
+    Stats::stopTimer(Stats::WAIT_NS);
+    return reply;
+}
+
+int API::readByte() {
+#ifndef _WIN32
+    if (0 <= m_socket) {
+        unsigned char c;
+        return read(m_socket, &c, 1) == 1 ? c : -1;
+    }
+#endif
+    int c = std::cin.get();
+    return c == std::char_traits<char>::eof() ? -1 : c;
+}
+
+void API::write(const char* data, int size) {
+#ifndef _WIN32
+    if (0 <= m_socket) {
+        while (0 < size) {
+            int written = ::write(m_socket, data, size);
+            if (written <= 0) {
+                return;
+            }
+            data += written;
+            size -= written;
+        }
+        return;
+    }
+#endif
+    std::cout.write(data, size);
+    std::cout.flush();
 }
@@ -2,6 +2,9 @@
 
 #include <string>
 
+#include "Byte.h"
+#include "ThreadLocal.h"
+
 class API {
 
 public:
@@ -13,7 +16,21 @@ public:
     static bool wallRight();
     static bool wallLeft();
 
+    // All of the walls around the mouse, sensed at once: the wall to the
+    // front is bit 0, to the right is bit 1, and to the left is bit 3 (i.e.,
+    // bit n is n right turns away). Over the mms protocol, the three queries
+    // are pipelined, so that they take a single round trip.
+    static int readWalls();
+
     static void moveForward();
+    static void moveForward(int distance);
+
+    // Sends a moveForward without waiting for it to complete, so that the
+    // mouse can plan while it moves. No other command that needs a response
+    // may be sent until finishMove() has collected this one's.
+    static void startMoveForward();
+    static void finishMove();
+
     static void turnRight();
     static void turnLeft();
 
@@ -31,4 +48,51 @@ public:
     static bool wasReset();
     static void ackReset();
 
+    // When buffered, fire-and-forget commands (setWall, setColor, setText,
+    // clear*) are queued and only flushed right before the next command that
+    // needs a response (wallFront, moveForward, wasReset, etc.)
+    static void setBuffered(bool buffered);
+
+    // The number of times the command channel has been flushed
+    static int getFlushCount();
+    static void resetFlushCount();
+
+    // Asks the simulator to switch to the compact binary framing of the
+    // protocol (see Protocol.h), either over stdin and stdout, or over the
+    // Unix domain socket at the given path, if it isn't NULL. Returns whether
+    // the simulator agreed; if not, the text protocol over stdin and stdout
+    // remains in use. Note that mms itself only speaks text.
+    static bool useBinaryProtocol(const char* socketPath);
+
+    // Starts recording the simulator's answers, and the mouse's moves, to a
+    // Trace at the given path, which can be replayed without the simulator.
+    // Returns false if the trace couldn't be written.
+    static bool recordTrace(const char* path);
+
+private:
+
+    // The size of the buffer that binary commands are queued in
+    static const twobyte FRAME_BUFFER_SIZE = 4096;
+
+    static THREAD_LOCAL bool m_buffered;
+    static THREAD_LOCAL int m_flushCount;
+
+    static THREAD_LOCAL bool m_binary; // Whether the binary protocol is in use
+    static THREAD_LOCAL int m_socket; // Or -1, for stdin and stdout
+    static THREAD_LOCAL char m_frames[FRAME_BUFFER_SIZE];
+    static THREAD_LOCAL twobyte m_numFrameBytes;
+
+    static void endCommand();
+    static void endQuery();
+    static void flush();
+    static std::string readResponse();
+
+    // Helpers for the binary protocol
+    static void beginFrame(byte opcode);
+    static void put(byte value);
+    static int query(byte opcode);
+    static int readReply();
+    static int readByte();
+    static void write(const char* data, int size);
+
 };
@@ -5,50 +5,85 @@
 
 #include "API.h"
 #include "Assert.h"
+#include "Corridors.h"
+#include "Diagonal.h"
+#include "Fields.h"
+#include "Flood.h"
 #include "History.h"
 #include "Maze.h"
 #include "Mode.h"
+#include "PathCache.h"
+#include "Snapshot.h"
+#include "Stats.h"
+
+Algo::Algo() : m_costs(CostModel::parameters()) {
+}
+
+void Algo::setCostParameters(const CostParameters& parameters) {
+    ASSERT_LT(0, parameters.turnCost);
+    ASSERT_LT(parameters.turnCost, 257);
+    ASSERT_LT(0, parameters.minStraightAwayCost);
+    ASSERT_LT(parameters.minStraightAwayCost, 257);
+    ASSERT_LT(parameters.straightAwayCost, 257);
+    m_costs = CostTable<Maze::MAX_LENGTH>(parameters);
+}
+
+CostParameters Algo::getDefaultCostParameters() {
+    return CostModel::parameters();
+}
 
 void Algo::solve() {
 
-    // Ensure that the maze size is sane
-    if (!(
-        1 <= Maze::WIDTH &&
-        1 <= Maze::HEIGHT &&
-        Maze::WIDTH <= 16 &&
-        Maze::HEIGHT <= 16
-    )) {
-        std::cerr << "ERROR - Maze::WIDTH and Maze::HEIGHT must be in [1, 16]"
-                  << std::endl;
-        return;
+    // Switch to the binary protocol, if the simulator supports it
+    if (shouldUseBinaryProtocol() &&
+        !API::useBinaryProtocol(getSimulatorSocketPath())) {
+        std::cerr << "The simulator declined the binary protocol, "
+                  << "so using the text protocol instead" << std::endl;
     }
 
-    // Ensure that the maze size is as expected
+    // Record the run, so that it can be replayed without the simulator
+    if (shouldRecordTrace() && !API::recordTrace(getTracePath())) {
+        std::cerr << "Couldn't record a trace to " << getTracePath()
+                  << ", so running without one" << std::endl;
+    }
+
+    // Use the actual maze size, provided that we were built to handle it
+    int width = API::mazeWidth();
+    int height = API::mazeHeight();
     if (!(
-        Maze::WIDTH == API::mazeWidth() &&
-        Maze::HEIGHT == API::mazeHeight()
+        1 <= width &&
+        1 <= height &&
+        width <= Maze::MAX_WIDTH &&
+        height <= Maze::MAX_HEIGHT
     )) {
-        std::cerr << "WARNING - configured for "
-                  << static_cast<unsigned int>(Maze::WIDTH) << " x "
-                  << static_cast<unsigned int>(Maze::HEIGHT)
-                  << " maze, but actual maze size is "
-                  << API::mazeWidth() << " x "
-                  << API::mazeHeight() << std::endl;
+        std::cerr << "ERROR - actual maze size is "
+                  << width << " x " << height
+                  << ", but this build only supports mazes up to "
+                  << static_cast<unsigned int>(Maze::MAX_WIDTH) << " x "
+                  << static_cast<unsigned int>(Maze::MAX_HEIGHT)
+                  << " (see MAX_MAZE_SIZE)" << std::endl;
+        return;
     }
+    Maze::clear();
+    Maze::setSize(width, height);
+    History::clear();
+    PathCache::clear();
+    Corridors::invalidate();
+    Fields::clear();
 
     // Initialize the (perimeter of the) maze
-    for (byte x = 0; x < Maze::WIDTH; x += 1) {
-        for (byte y = 0; y < Maze::HEIGHT; y += 1) {
+    for (byte x = 0; x < Maze::getWidth(); x += 1) {
+        for (byte y = 0; y < Maze::getHeight(); y += 1) {
             if (x == 0) { 
                 setCellWall(Maze::getCell(x, y), Direction::WEST, true);
             }
             if (y == 0) {
                 setCellWall(Maze::getCell(x, y), Direction::SOUTH, true);
             }
-            if (x == Maze::WIDTH - 1) {
+            if (x == Maze::getWidth() - 1) {
                 setCellWall(Maze::getCell(x, y), Direction::EAST, true);
             }
-            if (y == Maze::HEIGHT - 1) {
+            if (y == Maze::getHeight() - 1) {
                 setCellWall(Maze::getCell(x, y), Direction::NORTH, true);
             }
         }
@@ -58,30 +93,117 @@ void Algo::solve() {
     m_x = 0;
     m_y = 0;
     m_d = Direction::NORTH;
+    m_initialDirection = Direction::NORTH;
     m_mode = Mode::CENTER;
+    m_fieldValid = false;
+    m_fieldMode = Mode::CENTER;
+    m_updatingStoredField = false;
+    m_explored = false;
+    m_speculated = false;
+
+    // Queue up visualization commands rather than flushing each one
+    API::setBuffered(shouldBufferCommands());
+
+    // Pick up where we left off, if we were restarted. The mouse is always
+    // put back at the origin, so we only need the walls (and whether or not
+    // we'd finished exploring), and can head straight for the speed run.
+    Pose pose;
+    if (shouldPersistSnapshot() && Snapshot::load(getSnapshotPath(), &pose)) {
+        std::cerr << "Loaded snapshot taken at ("
+                  << static_cast<unsigned int>(pose.x) << ", "
+                  << static_cast<unsigned int>(pose.y) << ")" << std::endl;
+        m_explored = pose.explored;
+        if (!HEADLESS) {
+            drawKnownWalls();
+        }
+    }
 
     // Perform a series of strategical steps ad infinitum
     while (true) {
 
+        // Count the number of flushes for this step only
+        API::resetFlushCount();
+        Stats::startTimer(Stats::STEP_NS);
+
         // Clear all tile color, and color the center
-        API::clearAllColor();
-        API::setColor(0, 0, 'G');
-        colorCenter('G');
+        if (!HEADLESS) {
+            API::clearAllColor();
+            API::setColor(0, 0, 'G');
+            colorCenter('G');
+        }
 
         // If requested, reset the mouse state and undo cell wall info
         if (resetButtonPressed()) {
             reset();
         }
 
+        // A reset puts us back in CENTER mode, but that isn't the end of an
+        // episode, so only the step itself can change the mode that counts
+        byte mode = m_mode;
+
         // Perform a movement that will take us closer to the destination 
         step();
 
+        // If requested, report how many times we flushed during the step
+        if (shouldPrintFlushCount()) {
+            std::cerr << "Flushes: " << API::getFlushCount() << std::endl;
+        }
+
+        // Account for the step, and summarize the episode if it's over
+        Stats::stopTimer(Stats::STEP_NS);
+        Stats::endStep();
+        if (m_mode != mode && shouldPrintStats()) {
+            Stats::reportEpisode(
+                std::cerr, Mode::name(mode), Mode::name(m_mode),
+                shouldPrintStatsAsJson()
+            );
+        }
+
+        // Reaching the destination vouches for the walls learned on the way
+        if (m_mode != mode) {
+            History::checkpoint();
+        }
+
+        // Save what we've learned whenever an episode ends
+        if (m_mode != mode && shouldPersistSnapshot()) {
+            pose.x = m_x;
+            pose.y = m_y;
+            pose.direction = m_d;
+            pose.mode = m_mode;
+            pose.explored = m_explored;
+            if (!Snapshot::save(getSnapshotPath(), pose)) {
+                std::cerr << "ERROR - couldn't save snapshot to "
+                          << getSnapshotPath() << std::endl;
+            }
+        }
+
         // If the maze is unsolvable, give up
         if (m_mode == Mode::GIVEUP) {
+            if (DUMP_DISTANCES) {
+                dumpDistances();
+            }
             std::cerr << "Unsolvable maze detected. I'm giving up..."
                       << std::endl;
             break;
         }
+
+        // If an assertion failed on the robot, stop and report the fault code
+        if (ASSERT_POLICY == ASSERT_FAULT && Assert::fault() != 0) {
+            std::cerr << "Fault code " << Assert::fault()
+                      << " (assertion failed). Stopping..." << std::endl;
+            break;
+        }
+
+        // If the speed run is over, we're done
+        if (m_mode == Mode::DONE) {
+            std::cerr << "Speed run complete." << std::endl;
+            break;
+        }
+    }
+
+    // Summarize the whole run
+    if (shouldPrintStats()) {
+        Stats::reportRun(std::cerr, "exit", shouldPrintStatsAsJson());
     }
 }
 
@@ -93,6 +215,52 @@ byte Algo::colorVisitedCellsDelayMs() const {
     return 10;
 }
 
+bool Algo::shouldBufferCommands() const {
+    return true;
+}
+
+bool Algo::shouldPrintFlushCount() const {
+    return false;
+}
+
+bool Algo::shouldReadWallsTogether() const {
+    return true;
+}
+
+bool Algo::shouldUseBinaryProtocol() const {
+    // Only for simulators that support it (see Protocol.h), since mms doesn't
+    return false;
+}
+
+const char* Algo::getSimulatorSocketPath() const {
+    // Or NULL, to use stdin and stdout
+    return NULL;
+}
+
+bool Algo::shouldRecordTrace() const {
+    return false;
+}
+
+const char* Algo::getTracePath() const {
+    return "mackalgo.trace";
+}
+
+bool Algo::shouldPersistSnapshot() const {
+    return false;
+}
+
+const char* Algo::getSnapshotPath() const {
+    return "mackalgo.snapshot";
+}
+
+bool Algo::shouldPrintStats() const {
+    return true;
+}
+
+bool Algo::shouldPrintStatsAsJson() const {
+    return true;
+}
+
 bool Algo::resetButtonPressed() {
     return API::wasReset();
 }
@@ -102,11 +270,11 @@ void Algo::acknowledgeResetButtonPressed() {
 }
 
 twobyte Algo::getTurnCost() {
-    return (FAST_STRAIGHT_AWAYS ? 256 : 2);
+    return m_costs.turnCost;
 }
 
 twobyte Algo::getStraightAwayCost(byte length) {
-    return (FAST_STRAIGHT_AWAYS ? 256 / length : 3);
+    return m_costs.straightAwayCost[length];
 }
 
 void Algo::reset() {
@@ -119,16 +287,24 @@ void Algo::reset() {
     m_y = 0;
     m_d = m_initialDirection;
     m_mode = Mode::CENTER;
+    m_fieldValid = false;
+    m_explored = false;
+    m_speculated = false;
+    Fields::clear();
     Maze::setStraightAwayLength(Maze::getCell(0, 0), 0);
 
-    // Roll back some cell wall data
-    while (0 < History::size()) {
-        twobyte cellAndData = History::pop();
-        byte cell = History::cell(cellAndData);
-        byte data = History::data(cellAndData);
-        for (byte direction = 0; direction < 4; direction += 1) {
-            if ((data >> (direction + 4)) & 1) {
-                unsetCellWall(cell, direction, true);
+    // Forget all of the cell wall data learned since the last checkpoint at
+    // once, and then (only if visualizing) erase the walls that were drawn
+    twobyte numUndone = History::rollback();
+    if (!HEADLESS) {
+        for (twobyte i = 0; i < numUndone; i += 1) {
+            unsigned int cellAndData = History::undone(i);
+            cellindex cell = History::cell(cellAndData);
+            byte data = History::data(cellAndData);
+            for (byte direction = 0; direction < 4; direction += 1) {
+                if ((data >> (direction + 4)) & 1 && (data >> direction) & 1) {
+                    eraseCellWall(cell, direction);
+                }
             }
         }
     }
@@ -136,44 +312,125 @@ void Algo::reset() {
 
 void Algo::step() {
 
-    // Read the walls if unknown
-    readWalls();
+    Stats::count(Stats::STEPS);
+
+    // Read the walls if unknown. If we planned a path while moving here, it
+    // assumed that these walls were absent, in which case it's exactly the
+    // path that we'd plan now.
+    byte learned = readWalls();
+    bool speculated = m_speculated && (learned & 0x0F) == 0;
+    m_speculated = false;
 
     // Get the current cell
-    byte current = Maze::getCell(m_x, m_y);
+    cellindex current = Maze::getCell(m_x, m_y);
+
+    // Exploration has its own targets, which change as walls are learned
+    if (m_mode == Mode::EXPLORE) {
+        explore(current);
+        return;
+    }
+
+    // Give up if the destination can't be reached even if every unknown wall
+    // is absent. The bitboard flood fill is much cheaper than letting
+    // Dijkstra's algo exhaust the maze in order to come to the same conclusion.
+    Bitboard destinations;
+    getDestinations(&destinations);
+    setGoals(destinations);
+    if (!Flood::canReach(current, destinations, true)) {
+        m_mode = Mode::GIVEUP;
+        return;
+    }
 
     // Generate a path from the current cell to the destination
-    byte start = generatePath(current);
+    bool solvable = true;
+    if (speculated) {
+        Stats::count(Stats::SPECULATION_HITS);
+    }
+    else {
+        Stats::count(Stats::PLANS);
+        Stats::startTimer(Stats::PLAN_NS);
+        solvable = (
+            INCREMENTAL_PLANNING ?
+            updateField(current) :
+            generatePath(current) == current
+        );
+        Stats::stopTimer(Stats::PLAN_NS);
+    }
 
     // Invalid path, maze not solvable
-    if (start != current) {
+    if (!solvable) {
         m_mode = Mode::GIVEUP;
         return;
     }
 
     // Draw the path from the current position to the destination
-    drawPath(start);
+    if (!HEADLESS) {
+        drawPath(current);
+    }
 
-    // Move along the path as far as possible
-    followPath(start);
+    // Move along the path as far as possible. If the whole path is known,
+    // as it is during a speed run, compile it into a list of straightaways
+    // so that each one takes a single round trip to the API.
+    if (Maze::hasNext(getFirstUnknown(current))) {
+        followPath(current);
+    }
+    else {
+        if (DIAGONAL_PLANNING) {
+            planDiagonals(current, destinations);
+        }
+        Segment segments[Maze::MAX_CELLS];
+        followSegments(segments, compilePath(current, segments));
+    }
 
     // Update the mode if we've reached the destination
     if (m_mode == Mode::CENTER && inCenter(m_x, m_y)) {
         std::cerr << "Success!" << std::endl;
-        m_mode = Mode::ORIGIN;
+        if (DUMP_DISTANCES) {
+            dumpDistances();
+        }
+        if (!TARGETED_EXPLORATION) {
+            m_mode = Mode::ORIGIN;
+        }
+        else if (m_explored) {
+            m_mode = Mode::DONE;
+        }
+        else {
+            m_mode = Mode::EXPLORE;
+        }
+        if (!DUAL_FIELDS) {
+            m_fieldValid = false;
+        }
     }
     if (m_mode == Mode::ORIGIN && inOrigin(m_x, m_y)) {
+        if (DUMP_DISTANCES) {
+            dumpDistances();
+        }
         m_mode = Mode::CENTER;
+        if (!DUAL_FIELDS) {
+            m_fieldValid = false;
+        }
     }
 }
 
-byte Algo::generatePath(byte start) {
+cellindex Algo::generatePath(cellindex start) {
+
+    // Planning from the same cell, heading, and speed, to the same
+    // destination, with the same walls, gives the same path as before
+    PathKey key = {
+        Maze::getVersion(), start, m_d, m_mode, Maze::getStraightAwayLength(start)
+    };
+    if (CACHE_PATHS && PathCache::restore(key)) {
+        Stats::count(Stats::PATH_CACHE_HITS);
+        return start;
+    }
 
     // Reset the sequence bit of all cells
-    for (byte x = 0; x < Maze::WIDTH; x += 1) {
-        for (byte y = 0; y < Maze::HEIGHT; y += 1) {
-            Maze::setDiscovered(Maze::getCell(x, y), false);
-        }
+    Maze::clearAllDiscovered();
+    if (CORRIDOR_GRAPH) {
+        Corridors::update();
+    }
+    if (A_STAR) {
+        setEstimates();
     }
 
     // Initialize the starting cell
@@ -192,40 +449,61 @@ byte Algo::generatePath(byte start) {
     resetDestinationCellDistances();
 
     // Cache the value of shouldColorVisitedCells
-    bool colorVisitedCells = shouldColorVisitedCells();
-
-    // Dijkstra's algo
-    ASSERT_EQ(Heap::size(), 0);
-    Heap::push(start);
-    while (0 < Heap::size()) {
-        byte cell = Heap::pop();
+    bool colorVisitedCells = !HEADLESS && shouldColorVisitedCells();
+
+    // Dijkstra's algo. Since cells are settled in order of their distance,
+    // the first destination cell to be settled is the closest one (and if
+    // none is, the path is invalid, whichever destination cell we pick).
+    cellindex closest = getClosestDestinationCell();
+    ASSERT_EQ(Frontier::size(), 0);
+    Frontier::push(start);
+    while (0 < Frontier::size()) {
+        cellindex cell = Frontier::pop();
+        if (Maze::isGoal(cell)) {
+            closest = cell;
+            Frontier::clear();
+            break;
+        }
+        Stats::count(Stats::EXPANSIONS);
+        byte openDirections = Maze::getOpenDirections(cell);
         for (byte direction = 0; direction < 4; direction += 1) {
-            if (!Maze::isWall(cell, direction)) {
+            if (!((openDirections >> direction) & 1)) {
+                continue;
+            }
+            if (CORRIDOR_GRAPH) {
+                checkCorridor(cell, direction, start);
+            }
+            else {
                 checkNeighbor(cell, direction);
             }
         }
         if (colorVisitedCells) {
             API::setColor(Maze::getX(cell), Maze::getY(cell), 'Y');
         }
-        if (cell == getClosestDestinationCell()) {
-            Heap::clear();
-            break;
-        }
+    }
+
+    // The other users of the frontier order cells by distance alone
+    if (A_STAR) {
+        Maze::clearAllEstimates();
     }
 
     // Reverse the linked list from the destination to the start (which we
     // built during our execution of Dijkstra's algo) into a linked list from
     // the start to the destination (which we use to instruct the robot's
     // movements).
-    return reverseLinkedList(getClosestDestinationCell());
+    cellindex first = reverseLinkedList(closest);
+    if (CACHE_PATHS && first == start) {
+        PathCache::store(key);
+    }
+    return first;
 }
 
-void Algo::drawPath(byte start) {
+void Algo::drawPath(cellindex start) {
     // This is probably a little two cutesy for it's own good. Oh well...
-    byte current = start;
+    cellindex current = start;
     for (byte i = 0; i < 2; i += 1) {
         while (Maze::hasNext(current)) {
-            byte next = getNeighboringCell(current, Maze::getNextDirection(current));
+            cellindex next = getNeighboringCell(current, Maze::getNextDirection(current));
             // Draw the "known" moves
             if (i == 0) {
                 if (!Maze::isKnown(current, Maze::getNextDirection(current))) {
@@ -242,29 +520,247 @@ void Algo::drawPath(byte start) {
     }
 }
 
-void Algo::followPath(byte start) {
+void Algo::followPath(cellindex start) {
 
     // Move forward as long as we know we won't collide with a wall
-    byte current = start;
+    cellindex current = start;
     while (Maze::hasNext(current) && Maze::isKnown(current, Maze::getNextDirection(current))) {
 
-        // Move to the next cell and advance our pointers
-        byte next = getNeighboringCell(current, Maze::getNextDirection(current));
-        moveOneCell(next);
+        // Move to the next cell and advance our pointers. If it's the last
+        // move of the step, plan the next step while the mouse is moving, at
+        // which point the planner no longer holds the rest of this path.
+        cellindex next = getNeighboringCell(current, Maze::getNextDirection(current));
+        bool last = !(Maze::hasNext(next) && Maze::isKnown(next, Maze::getNextDirection(next)));
+        bool overlap = SPECULATIVE_PLANNING && last && canSpeculate(next);
+        moveOneCell(next, !overlap);
+        if (overlap) {
+            speculate(next);
+            API::finishMove();
+        }
         current = next;
 
         // Inform the History class that the mouse has moved a cell
         History::move();
 
         // If the reset button was pressed, we should stop moving
+        if (resetButtonPressed() || overlap) {
+            break;
+        }
+    }
+}
+
+bool Algo::canSpeculate(cellindex next) {
+    // The next step must plan a path with generatePath, to the same goals
+    return (
+        !INCREMENTAL_PLANNING &&
+        (m_mode == Mode::CENTER || m_mode == Mode::ORIGIN) &&
+        !Maze::isGoal(next)
+    );
+}
+
+void Algo::speculate(cellindex start) {
+    // The mouse's state already reflects the move that's in flight, so the
+    // path is planned just as if it had arrived, with the walls unread
+    Stats::count(Stats::SPECULATIONS);
+    Stats::startTimer(Stats::PLAN_NS);
+    m_speculated = generatePath(start) == start;
+    Stats::stopTimer(Stats::PLAN_NS);
+}
+
+twobyte Algo::compilePath(cellindex start, Segment* segments) {
+    twobyte numSegments = 0;
+    byte heading = m_d;
+    cellindex current = start;
+    while (Maze::hasNext(current)) {
+        byte direction = Maze::getNextDirection(current);
+        if (numSegments == 0 || direction != heading) {
+            segments[numSegments].turn = (direction - heading + 4) % 4;
+            segments[numSegments].length = 0;
+            numSegments += 1;
+            heading = direction;
+        }
+        segments[numSegments - 1].length += 1;
+        current = getNeighboringCell(current, direction);
+    }
+    return numSegments;
+}
+
+void Algo::followSegments(const Segment* segments, twobyte numSegments) {
+    for (twobyte i = 0; i < numSegments; i += 1) {
+
+        // Turn to face the straightaway
+        switch (segments[i].turn) {
+            case 1:
+                turnRightUpdateState();
+                API::turnRight();
+                break;
+            case 2:
+                turnAroundUpdateState();
+                API::turnLeft();
+                API::turnLeft();
+                break;
+            case 3:
+                turnLeftUpdateState();
+                API::turnLeft();
+                break;
+        }
+
+        // Move the entire length of the straightaway at once
+        moveForwardUpdateState(segments[i].length);
+        API::moveForward(segments[i].length);
+        for (byte j = 0; j < segments[i].length; j += 1) {
+            History::move();
+        }
+
+        // We only check the reset button between straightaways
         if (resetButtonPressed()) {
             break;
         }
     }
 }
 
-byte Algo::getFirstUnknown(byte start) {
-    byte current = start;
+void Algo::planDiagonals(cellindex start, const Bitboard& destinations) {
+
+    // The API only knows how to move from cell to cell, so a diagonal route
+    // is still driven as a staircase. We use it for the route and the time
+    // estimates, which is what the real mouse would act on.
+    MotionProfile profile;
+    float orthogonalTime = Diagonal::estimate(start, m_d, profile);
+    float diagonalTime = Diagonal::plan(start, m_d, destinations, profile);
+    if (diagonalTime < 0) {
+        // Keep the orthogonal path, which is still in the "next" pointers
+        return;
+    }
+    std::cerr << "Orthogonal: " << orthogonalTime << "s, "
+              << "Diagonal: " << diagonalTime << "s" << std::endl;
+
+    // The route overwrote some of the "next" pointers of the distance field
+    m_fieldValid = false;
+
+    // Like our other planning, the diagonal planner settles each node on its
+    // first arrival, which isn't always optimal when acceleration depends on
+    // the length of the run. Fall back to the orthogonal path if it's faster.
+    if (orthogonalTime <= diagonalTime) {
+        if (INCREMENTAL_PLANNING) {
+            updateField(start);
+        }
+        else {
+            generatePath(start);
+        }
+    }
+    if (!HEADLESS) {
+        drawPath(start);
+    }
+}
+
+void Algo::explore(cellindex start) {
+
+    // Once no unknown wall can shorten the path, head back for the speed run
+    Bitboard targets;
+    if (!getExplorationTargets(&targets)) {
+        std::cerr << "Exploration complete." << std::endl;
+        m_explored = true;
+        m_mode = Mode::ORIGIN;
+
+        // Neither field knows the walls learned while exploring, and the
+        // exploration routes overwrote the "next" pointers of the one in use
+        m_fieldValid = false;
+        Fields::clear();
+        return;
+    }
+
+    // A single flood fill from all of the targets at once tells us the way
+    // to the nearest one, from every cell, so we simply walk downhill,
+    // preferring to go straight. The targets are only those cells with
+    // unknown walls that lie on an optimistic path shorter than the known
+    // one, so the walk may well cross other cells with unknown walls, and
+    // assume them absent. That's safe only because followPath() stops at
+    // the first unknown wall, after which we flood again with what's learned.
+    static THREAD_LOCAL twobyte distances[Maze::MAX_CELLS];
+    Flood::distances(targets, true, distances);
+    ASSERT_LT(distances[start], Flood::UNREACHABLE);
+    cellindex current = start;
+    byte heading = m_d;
+    while (0 < distances[current]) {
+        byte openDirections = Maze::getOpenDirections(current);
+        byte next = 4;
+        for (byte turn = 0; turn < 4; turn += 1) {
+            byte direction = (heading + turn) % 4;
+            if (((openDirections >> direction) & 1) &&
+                distances[Maze::getNeighbor(current, direction)] + 1 ==
+                distances[current]) {
+                next = direction;
+                break;
+            }
+        }
+        ASSERT_LT(next, 4);
+        Maze::setNextDirection(current, next);
+        current = Maze::getNeighbor(current, next);
+        heading = next;
+    }
+    Maze::clearNext(current);
+
+    if (!HEADLESS) {
+        drawPath(start);
+    }
+    followPath(start);
+}
+
+bool Algo::getExplorationTargets(Bitboard* targets) {
+
+    // Walls that the mouse can't possibly get to don't matter, and once
+    // every wall that it can get to is known, there's nothing left to learn
+    Bitboard origin;
+    origin.clear();
+    origin.set(Maze::getCell(0, 0));
+    Bitboard reachable;
+    Flood::reachable(origin, true, &reachable);
+    if (Flood::countUnknown(reachable) == 0) {
+        targets->clear();
+        return false;
+    }
+
+    // The number of moves from the origin and to the center, through each
+    // cell, assuming that all unknown walls are absent
+    static THREAD_LOCAL twobyte fromOrigin[Maze::MAX_CELLS];
+    static THREAD_LOCAL twobyte toCenter[Maze::MAX_CELLS];
+    static THREAD_LOCAL twobyte knownToCenter[Maze::MAX_CELLS];
+    Bitboard center;
+    getCenter(&center);
+    Flood::distances(origin, true, fromOrigin);
+    Flood::distances(center, true, toCenter);
+
+    // The length of the shortest path using only walls known to be absent
+    Flood::distances(center, false, knownToCenter);
+    unsigned int known = knownToCenter[Maze::getCell(0, 0)];
+
+    // Only a cell with an unknown wall, on an optimistic path that's shorter
+    // than the known one, can possibly shorten it. If there are none, the
+    // known path is as short as it can possibly be.
+    Bitboard unknown;
+    Flood::unknown(reachable, &unknown);
+    targets->clear();
+    for (twobyte i = 0; i < Bitboard::NUM_WORDS; i += 1) {
+        rowword word = unknown.words[i];
+        while (word) {
+            byte bit = __builtin_ctzll(word);
+            word &= word - 1;
+            cellindex cell = Maze::getCell(
+                (i % Maze::ROW_WORDS) * Maze::WORD_BITS + bit,
+                i / Maze::ROW_WORDS
+            );
+            if (fromOrigin[cell] < Flood::UNREACHABLE &&
+                toCenter[cell] < Flood::UNREACHABLE &&
+                static_cast<unsigned int>(fromOrigin[cell]) + toCenter[cell] < known) {
+                targets->set(cell);
+            }
+        }
+    }
+    return targets->any();
+}
+
+cellindex Algo::getFirstUnknown(cellindex start) {
+    cellindex current = start;
     while (Maze::hasNext(current) &&
            Maze::isKnown(current, Maze::getNextDirection(current))) {
         current = getNeighboringCell(current, Maze::getNextDirection(current));
@@ -272,15 +768,215 @@ byte Algo::getFirstUnknown(byte start) {
     return current;
 }
 
-void Algo::checkNeighbor(byte cell, byte direction) {
+bool Algo::updateField(cellindex start) {
+
+    // With a field for each destination, swap in the one for this mode. It
+    // may have been built long ago, but it's been kept up to date since.
+    if (DUAL_FIELDS && m_fieldMode != m_mode) {
+        m_fieldValid = Fields::swap(m_fieldValid);
+        m_fieldMode = m_mode;
+        if (!HEADLESS && m_fieldValid) {
+            drawDistances();
+        }
+    }
+
+    // Either build the field from scratch, or repair it using the walls that
+    // were learned since the last step. Note that learning that a wall is
+    // absent never changes the field, since unknown walls are assumed absent.
+    unsigned int cellAndData = History::peek();
+    if (m_fieldValid) {
+        repairField(History::cell(cellAndData), History::data(cellAndData));
+    }
+    else {
+        buildField();
+        m_fieldValid = true;
+    }
+
+    // Repair the other field with the same walls, so that it's ready to use
+    // as soon as the mouse turns around. Since the one in use is shown, the
+    // other one's repairs aren't.
+    if (DUAL_FIELDS && cellAndData != 0 && Fields::isValid()) {
+        Fields::swap(true);
+        m_updatingStoredField = true;
+        repairField(History::cell(cellAndData), History::data(cellAndData));
+        m_updatingStoredField = false;
+        Fields::swap(true);
+    }
+
+    // Since the field is rooted at the destination, each cell's "next"
+    // pointer already leads towards the destination, so there's no linked
+    // list to reverse. We need only check that the start was reached.
+    return Maze::getDiscovered(start);
+}
+
+void Algo::buildField() {
+
+    // Reset the sequence and "next" bits of all cells
+    Maze::clearAllDiscovered();
+    Maze::clearAllNext();
+
+    // Every destination cell is a root of the field
+    ASSERT_EQ(Frontier::size(), 0);
+    Maze::forEachGoal([this](cellindex cell) {
+        Maze::setDiscovered(cell, true);
+        Maze::setStraightAwayLength(cell, 0);
+        setCellDistance(cell, 0);
+        Frontier::push(cell);
+    });
+
+    // Unlike generatePath, we settle every reachable cell, so that the field
+    // stays usable no matter where the mouse goes next
+    expandField();
+}
+
+void Algo::repairField(cellindex cell, byte data) {
+
+    static twobyte maxDistance = Maze::MAX_DISTANCE;
+
+    // The cells whose routes to the destination are no longer valid
+    cellindex invalid[Maze::MAX_CELLS];
+    twobyte numInvalid = 0;
+
+    // A newly learned wall only invalidates the subtree (of cells routed
+    // through it) on whichever side of the wall was routed across it
+    for (byte direction = 0; direction < 4; direction += 1) {
+        if (!((data >> (direction + 4)) & 1) || !((data >> direction) & 1)) {
+            continue;
+        }
+        cellindex neighbor = getNeighboringCell(cell, direction);
+        cellindex sides[] = {cell, neighbor};
+        byte directions[] = {direction, getOppositeDirection(direction)};
+        for (byte i = 0; i < 2; i += 1) {
+            if (
+                Maze::getDiscovered(sides[i]) &&
+                Maze::hasNext(sides[i]) &&
+                Maze::getNextDirection(sides[i]) == directions[i]
+            ) {
+                Maze::setDiscovered(sides[i], false);
+                invalid[numInvalid] = sides[i];
+                numInvalid += 1;
+            }
+        }
+    }
+
+    // Collect the rest of the invalid subtrees, i.e., every cell whose "next"
+    // pointer leads to an invalid cell
+    for (twobyte i = 0; i < numInvalid; i += 1) {
+        cellindex current = invalid[i];
+        for (byte direction = 0; direction < 4; direction += 1) {
+            if (Maze::isWall(current, direction)) {
+                continue;
+            }
+            cellindex child = getNeighboringCell(current, direction);
+            if (
+                Maze::getDiscovered(child) &&
+                Maze::hasNext(child) &&
+                Maze::getNextDirection(child) == getOppositeDirection(direction)
+            ) {
+                Maze::setDiscovered(child, false);
+                invalid[numInvalid] = child;
+                numInvalid += 1;
+            }
+        }
+    }
+
+    // Forget the invalid labels
+    for (twobyte i = 0; i < numInvalid; i += 1) {
+        Maze::clearNext(invalid[i]);
+        setCellDistance(invalid[i], maxDistance);
+    }
+
+    // Seed the invalid cells from the valid cells that border them, and
+    // then let Dijkstra's algo fill in the rest of the invalid region
+    ASSERT_EQ(Frontier::size(), 0);
+    for (twobyte i = 0; i < numInvalid; i += 1) {
+        cellindex current = invalid[i];
+        for (byte direction = 0; direction < 4; direction += 1) {
+            if (Maze::isWall(current, direction)) {
+                continue;
+            }
+            cellindex neighbor = getNeighboringCell(current, direction);
+            if (Maze::getDiscovered(neighbor) && !Frontier::contains(neighbor)) {
+                checkNeighbor(neighbor, getOppositeDirection(direction));
+            }
+        }
+    }
+    expandField();
+}
+
+void Algo::expandField() {
+    while (0 < Frontier::size()) {
+        cellindex cell = Frontier::pop();
+        byte openDirections = Maze::getOpenDirections(cell);
+        for (byte direction = 0; direction < 4; direction += 1) {
+            if ((openDirections >> direction) & 1) {
+                checkNeighbor(cell, direction);
+            }
+        }
+    }
+}
+
+void Algo::setEstimates() {
+
+    // The bounding box of the goals
+    byte minX = Maze::getWidth();
+    byte maxX = 0;
+    byte minY = Maze::getHeight();
+    byte maxY = 0;
+    Maze::forEachGoal([&](cellindex cell) {
+        byte x = Maze::getX(cell);
+        byte y = Maze::getY(cell);
+        minX = x < minX ? x : minX;
+        maxX = maxX < x ? x : maxX;
+        minY = y < minY ? y : minY;
+        maxY = maxY < y ? y : maxY;
+    });
+
+    // Every move costs at least the cheapest one, and a turn costs at least
+    // the turn cost, so a cell that needs both horizontal and vertical moves
+    // to reach the box needs at least one of each. Note that this is only a
+    // lower bound because it doesn't depend on the mouse's heading.
+    for (byte x = 0; x < Maze::getWidth(); x += 1) {
+        for (byte y = 0; y < Maze::getHeight(); y += 1) {
+            byte dx = x < minX ? minX - x : (maxX < x ? x - maxX : 0);
+            byte dy = y < minY ? minY - y : (maxY < y ? y - maxY : 0);
+            twobyte moves = dx + dy;
+            twobyte turns = 0 < dx && 0 < dy ? 1 : 0;
+            Maze::setEstimate(Maze::getCell(x, y), (
+                turns * getTurnCost() + (moves - turns) * m_costs.minCost
+            ));
+        }
+    }
+}
+
+void Algo::raiseEstimate(cellindex cell, cellindex neighbor) {
+    // Since the estimates don't depend on the heading, they aren't consistent,
+    // e.g., a cell that is one move short of being in line with the goals may
+    // have a higher estimate than the cell that is in line, even though the
+    // turn is still ahead. Raising the estimate of each newly reached cell so
+    // that priorities never decrease along a path (i.e., "pathmax") keeps it
+    // a lower bound, and keeps the frontier's priorities from ever falling
+    // below that of the last cell popped. They can still jump ahead by more
+    // than a single edge cost (e.g., by a turn, plus the turn that the
+    // estimate adds once the cell is out of line with the goals), which the
+    // BucketQueue handles by overflowing them (see the A* rows of the
+    // benchmark's --frontier comparison).
+    if (Maze::getPriority(neighbor) < Maze::getPriority(cell)) {
+        Maze::setEstimate(neighbor, Maze::getPriority(cell) - Maze::getDistance(neighbor));
+    }
+}
+
+void Algo::checkNeighbor(cellindex cell, byte direction) {
 
     // Retrieve the neighboring cell, and the direction that would take us from
     // the neighboring cell to the current cell (which is the opposite of the
-    // direction that takes us from the current cell to the neighboring cell)
-    byte neighbor = getNeighboringCell(cell, direction);
+    // direction that takes us from the current cell to the neighboring cell).
+    // Note that we only check open directions, which always have a neighbor.
+    cellindex neighbor = Maze::getNeighbor(cell, direction);
     byte directionFromNeighbor = getOppositeDirection(direction);
 
     // Determine the cost if routed through the current cell
+    Stats::count(Stats::RELAXATIONS);
     twobyte costToNeighbor = Maze::getDistance(cell) + (
         Maze::getNextDirection(cell) == directionFromNeighbor
         ? getStraightAwayCost(Maze::getStraightAwayLength(cell) + 1)
@@ -298,22 +994,90 @@ void Algo::checkNeighbor(byte cell, byte direction) {
             Maze::getNextDirection(cell) == directionFromNeighbor ?
             Maze::getStraightAwayLength(cell) + 1 : 1
         ));
+        if (A_STAR) {
+            raiseEstimate(cell, neighbor);
+        }
 
-        // Either discover (and push) the cell, or just update it
-        if (!Maze::getDiscovered(neighbor)) {
-            Maze::setDiscovered(neighbor, true);
-            Heap::push(neighbor);
+        // Either discover (and push) the cell, or just update it. Note that
+        // repairs to the incremental field may reopen a settled cell.
+        Maze::setDiscovered(neighbor, true);
+        if (!Frontier::contains(neighbor)) {
+            Frontier::push(neighbor);
         }
         else {
-            Heap::update(neighbor);
+            Frontier::update(neighbor);
         }
     }
 }
 
-byte Algo::reverseLinkedList(byte cell) {
-    byte closest = cell;
+void Algo::checkCorridor(cellindex cell, byte direction, cellindex start) {
+
+    // Don't go into dead ends, except to leave the one that we're in
+    cellindex neighbor = Maze::getNeighbor(cell, direction);
+    if (Corridors::isPruned(neighbor) && !(
+        Corridors::isPruned(cell) && Corridors::getExit(cell) == direction
+    )) {
+        return;
+    }
+    if (!Corridors::isCorridor(neighbor) || neighbor == start) {
+        checkNeighbor(cell, direction);
+        return;
+    }
+
+    // Otherwise jump to the far end of the corridor, adding up the cost of
+    // each move along the way, just as checkNeighbor() would have. Since the
+    // start has distance zero, the jump must end there if it gets there.
+    Stats::count(Stats::RELAXATIONS);
+    byte directionFromNeighbor = getOppositeDirection(direction);
+    bool straight = Maze::getNextDirection(cell) == directionFromNeighbor;
+    byte length = straight ? Maze::getStraightAwayLength(cell) + 1 : 1;
+    twobyte cost = Maze::getDistance(cell) + (
+        straight ? getStraightAwayCost(length) : getTurnCost()
+    );
+    byte firstLength = length;
+    twobyte firstCost = cost;
+    cellindex end = neighbor;
+    while (Corridors::isCorridor(end) && end != start) {
+        end = Maze::getNeighbor(end, direction);
+        length += 1;
+        cost += getStraightAwayCost(length);
+    }
+    if (Maze::getDiscovered(end) && Maze::getDistance(end) <= cost) {
+        return;
+    }
+
+    // The cells along the corridor are never pushed, but their planner info
+    // must still lead back through the corridor
+    length = firstLength;
+    cost = firstCost;
+    for (cellindex current = neighbor; current != end;) {
+        setCellDistance(current, cost);
+        Maze::setNextDirection(current, directionFromNeighbor);
+        Maze::setStraightAwayLength(current, length);
+        Maze::setDiscovered(current, true);
+        current = Maze::getNeighbor(current, direction);
+        length += 1;
+        cost += getStraightAwayCost(length);
+    }
+    setCellDistance(end, cost);
+    Maze::setNextDirection(end, directionFromNeighbor);
+    Maze::setStraightAwayLength(end, length);
+    Maze::setDiscovered(end, true);
+    if (A_STAR) {
+        raiseEstimate(cell, end);
+    }
+    if (!Frontier::contains(end)) {
+        Frontier::push(end);
+    }
+    else {
+        Frontier::update(end);
+    }
+}
+
+cellindex Algo::reverseLinkedList(cellindex cell) {
+    cellindex closest = cell;
     byte direction = Maze::getNextDirection(closest);
-    byte current = getNeighboringCell(closest, direction);
+    cellindex current = getNeighboringCell(closest, direction);
     Maze::clearNext(closest);
     while (Maze::hasNext(current)) {
         byte temp = Maze::getNextDirection(current);
@@ -327,112 +1091,132 @@ byte Algo::reverseLinkedList(byte cell) {
 }
 
 bool Algo::inCenter(byte x, byte y) {
-    for (byte xx = Maze::CLLX; xx <= Maze::CURX; xx += 1) {
-        for (byte yy = Maze::CLLY; yy <= Maze::CURY; yy += 1) {
-            if (x == xx && y == yy) {
-                return true;
-            }
-        }
-    }
-    return false;
+    return (
+        Maze::getCLLX() <= x && x <= Maze::getCURX() &&
+        Maze::getCLLY() <= y && y <= Maze::getCURY()
+    );
 }
 
 bool Algo::inOrigin(byte x, byte y) {
     return x == 0 && y == 0;
 }
 
-void Algo::colorCenter(char color) {
-    for (byte x = Maze::CLLX; x <= Maze::CURX; x += 1) {
-        for (byte y = Maze::CLLY; y <= Maze::CURY; y += 1) {
-            API::setColor(x, y, color);
+void Algo::getCenter(Bitboard* center) {
+    center->clear();
+    for (byte x = Maze::getCLLX(); x <= Maze::getCURX(); x += 1) {
+        for (byte y = Maze::getCLLY(); y <= Maze::getCURY(); y += 1) {
+            center->set(Maze::getCell(x, y));
         }
     }
 }
 
-void Algo::resetDestinationCellDistances() {
-    static twobyte maxDistance = 65535;
+void Algo::getDestinations(Bitboard* destinations) {
     if (m_mode == Mode::CENTER) {
-        for (byte x = Maze::CLLX; x <= Maze::CURX; x += 1) {
-            for (byte y = Maze::CLLY; y <= Maze::CURY; y += 1) {
-                setCellDistance(Maze::getCell(x, y), maxDistance);
-            }
-        }
+        getCenter(destinations);
     }
     else {
-        setCellDistance(Maze::getCell(0, 0), maxDistance);
+        destinations->clear();
+        destinations->set(Maze::getCell(0, 0));
     }
 }
 
-byte Algo::getClosestDestinationCell() {
-    byte closest = Maze::getCell(Maze::CLLX, Maze::CLLY);
-    if (m_mode == Mode::CENTER) {
-        for (byte x = Maze::CLLX; x <= Maze::CURX; x += 1) {
-            for (byte y = Maze::CLLY; y <= Maze::CURY; y += 1) {
-                byte other = Maze::getCell(x, y);
-                if (Maze::getDistance(other) < Maze::getDistance(closest)) {
-                    closest = other;
+void Algo::setGoals(const Bitboard& goals) {
+    // Any set of cells will do, e.g., a larger goal region, or waypoints
+    Maze::clearAllGoals();
+    for (twobyte i = 0; i < Bitboard::NUM_WORDS; i += 1) {
+        rowword word = goals.words[i];
+        while (word) {
+            byte bit = __builtin_ctzll(word);
+            word &= word - 1;
+            Maze::setGoal(Maze::getCell(
+                (i % Maze::ROW_WORDS) * Maze::WORD_BITS + bit,
+                i / Maze::ROW_WORDS
+            ));
+        }
+    }
+}
+
+void Algo::drawKnownWalls() {
+    for (byte x = 0; x < Maze::getWidth(); x += 1) {
+        for (byte y = 0; y < Maze::getHeight(); y += 1) {
+            cellindex cell = Maze::getCell(x, y);
+            for (byte direction = 0; direction < 4; direction += 1) {
+                if (Maze::isKnown(cell, direction) && Maze::isWall(cell, direction)) {
+                    setCellWall(cell, direction, true);
                 }
             }
         }
     }
-    else {
-        closest = Maze::getCell(0, 0);
-    }
-    return closest;
 }
 
-byte Algo::getOppositeDirection(byte direction) {
-    switch (direction) {
-        case Direction::NORTH:
-            return Direction::SOUTH;
-        case Direction::EAST:
-            return Direction::WEST;
-        case Direction::SOUTH:
-            return Direction::NORTH;
-        case Direction::WEST:
-            return Direction::EAST;
-        default:
-            ASSERT_TR(false);
+void Algo::colorCenter(char color) {
+    for (byte x = Maze::getCLLX(); x <= Maze::getCURX(); x += 1) {
+        for (byte y = Maze::getCLLY(); y <= Maze::getCURY(); y += 1) {
+            API::setColor(x, y, color);
+        }
     }
 }
 
-bool Algo::hasNeighboringCell(byte cell, byte direction) {
-
-    byte x = Maze::getX(cell);
-    byte y = Maze::getY(cell);
+void Algo::dumpDistances() {
+    // Top row first, so that the output looks like the maze
+    for (byte y = Maze::getHeight(); 0 < y; y -= 1) {
+        for (byte x = 0; x < Maze::getWidth(); x += 1) {
+            cellindex cell = Maze::getCell(x, y - 1);
+            std::cerr.width(6);
+            if (Maze::getDiscovered(cell)) {
+                std::cerr << Maze::getDistance(cell);
+            }
+            else {
+                std::cerr << "-";
+            }
+        }
+        std::cerr << std::endl;
+    }
+}
 
-    switch (direction) {
-        case Direction::NORTH:
-            return y < Maze::HEIGHT - 1;
-        case Direction::EAST:
-            return x < Maze::WIDTH - 1;
-        case Direction::SOUTH:
-            return 0 < y;
-        case Direction::WEST:
-            return 0 < x;
+void Algo::drawDistances() {
+    for (byte x = 0; x < Maze::getWidth(); x += 1) {
+        for (byte y = 0; y < Maze::getHeight(); y += 1) {
+            cellindex cell = Maze::getCell(x, y);
+            setCellDistance(cell, Maze::getDistance(cell));
+        }
     }
 }
 
-byte Algo::getNeighboringCell(byte cell, byte direction) {
+void Algo::resetDestinationCellDistances() {
+    static twobyte maxDistance = Maze::MAX_DISTANCE;
+    Maze::forEachGoal([this](cellindex cell) {
+        setCellDistance(cell, maxDistance);
+    });
+}
 
-    ASSERT_TR(hasNeighboringCell(cell, direction));
+cellindex Algo::getClosestDestinationCell() {
+    cellindex closest = 0;
+    bool found = false;
+    Maze::forEachGoal([&](cellindex cell) {
+        if (!found || Maze::getDistance(cell) < Maze::getDistance(closest)) {
+            closest = cell;
+            found = true;
+        }
+    });
+    ASSERT_TR(found);
+    return closest;
+}
 
-    byte x = Maze::getX(cell);
-    byte y = Maze::getY(cell);
+byte Algo::getOppositeDirection(byte direction) {
+    return (direction + 2) % 4;
+}
 
-    switch (direction) {
-        case Direction::NORTH:
-            return Maze::getCell(x, y + 1);
-        case Direction::EAST:
-            return Maze::getCell(x + 1, y);
-        case Direction::SOUTH:
-            return Maze::getCell(x, y - 1);
-        case Direction::WEST:
-            return Maze::getCell(x - 1, y);
-    }
+bool Algo::hasNeighboringCell(cellindex cell, byte direction) {
+    return Maze::hasNeighbor(cell, direction);
 }
 
-bool Algo::isOneCellAway(byte target) {
+cellindex Algo::getNeighboringCell(cellindex cell, byte direction) {
+    ASSERT_TR(hasNeighboringCell(cell, direction));
+    return Maze::getNeighbor(cell, direction);
+}
+
+bool Algo::isOneCellAway(cellindex target) {
 
     byte x = Maze::getX(target);
     byte y = Maze::getY(target);
@@ -453,7 +1237,7 @@ bool Algo::isOneCellAway(byte target) {
     return false;
 }
 
-void Algo::moveOneCell(byte target) {
+void Algo::moveOneCell(cellindex target, bool wait) {
 
     ASSERT_TR(isOneCellAway(target));
 
@@ -472,25 +1256,33 @@ void Algo::moveOneCell(byte target) {
     }
 
     if (moveDirection == m_d) {
-        moveForward();
+        moveForward(wait);
     }
     else if (moveDirection == (m_d + 1) % 4) {
-        rightAndForward();
+        rightAndForward(wait);
     }
     else if (moveDirection == (m_d + 2) % 4) {
-        aroundAndForward();
+        aroundAndForward(wait);
     }
     else if (moveDirection == (m_d + 3) % 4) {
-        leftAndForward();
+        leftAndForward(wait);
     }
 }
 
-void Algo::readWalls() {
+byte Algo::readWalls() {
 
     // Record the cell and wall data for the History
-    byte cell = Maze::getCell(m_x, m_y);
+    cellindex cell = Maze::getCell(m_x, m_y);
     byte data = 0;
 
+    // Sense all of the walls in a single round trip, unless they're known
+    bool together = shouldReadWallsTogether() && (
+        !Maze::isKnown(cell, (m_d + 3) % 4) ||
+        !Maze::isKnown(cell, m_d) ||
+        !Maze::isKnown(cell, (m_d + 1) % 4)
+    );
+    int walls = together ? API::readWalls() : 0;
+
     // For each of [left, front, right]
     for (int i = -1; i <= 1; i += 1) {
         byte direction = (m_d + i + 4) % 4;
@@ -499,7 +1291,7 @@ void Algo::readWalls() {
         if (!Maze::isKnown(m_x, m_y, direction)) {
 
             // Read and update the wall value
-            bool isWall = readWall(direction);
+            bool isWall = together ? (walls >> ((i + 4) % 4)) & 1 : readWall(direction);
             setCellWall(Maze::getCell(m_x, m_y), direction, isWall);
 
             // Set the "learned" bit, as well as "walls" bit
@@ -512,6 +1304,7 @@ void Algo::readWalls() {
 
     // Actually add the learned cell walls to the History
     History::add(cell, data);
+    return data;
 }
 
 bool Algo::readWall(byte direction) {
@@ -525,6 +1318,7 @@ bool Algo::readWall(byte direction) {
     }
     // We should never get here
     ASSERT_TR(false);
+    return false;
 }
 
 void Algo::turnLeftUpdateState() {
@@ -539,67 +1333,78 @@ void Algo::turnAroundUpdateState() {
     m_d = (m_d + 2) % 4;
 }
 
-void Algo::moveForwardUpdateState() {
-    m_x += (m_d == Direction::EAST  ? 1 : (m_d == Direction::WEST  ? -1 : 0));
-    m_y += (m_d == Direction::NORTH ? 1 : (m_d == Direction::SOUTH ? -1 : 0));
+void Algo::moveForwardUpdateState(byte distance) {
+    m_x += (m_d == Direction::EAST  ? distance : (m_d == Direction::WEST  ? -distance : 0));
+    m_y += (m_d == Direction::NORTH ? distance : (m_d == Direction::SOUTH ? -distance : 0));
+    Stats::count(Stats::CELLS_MOVED, distance);
+    if (HEADLESS) {
+        return;
+    }
     std::cerr << "Moving to ("
               << static_cast<unsigned int>(m_x) << ", "
               << static_cast<unsigned int>(m_y) << ")"
               << std::endl;
 }
 
-void Algo::moveForward() {
+void Algo::moveForward(bool wait) {
     moveForwardUpdateState();
-    API::moveForward();
+    sendMoveForward(wait);
 }
 
-void Algo::leftAndForward() {
+void Algo::leftAndForward(bool wait) {
     turnLeftUpdateState();
     moveForwardUpdateState();
     API::turnLeft();
-    API::moveForward();
+    sendMoveForward(wait);
 }
 
-void Algo::rightAndForward() {
+void Algo::rightAndForward(bool wait) {
     turnRightUpdateState();
     moveForwardUpdateState();
     API::turnRight();
-    API::moveForward();
+    sendMoveForward(wait);
 }
 
-void Algo::aroundAndForward() {
+void Algo::aroundAndForward(bool wait) {
     turnAroundUpdateState();
     moveForwardUpdateState();
     API::turnLeft();
     API::turnLeft();
-    API::moveForward();
+    sendMoveForward(wait);
+}
+
+void Algo::sendMoveForward(bool wait) {
+    if (wait) {
+        API::moveForward();
+    }
+    else {
+        API::startMoveForward();
+    }
 }
 
-void Algo::setCellDistance(byte cell, twobyte distance) {
+void Algo::setCellDistance(cellindex cell, twobyte distance) {
     Maze::setDistance(cell, distance);
+    if (HEADLESS || m_updatingStoredField) {
+        return;
+    }
     std::ostringstream ss;
     ss << distance;
     API::setText(Maze::getX(cell), Maze::getY(cell), ss.str());
 }
 
-void Algo::setCellWall(byte cell, byte direction, bool isWall, bool bothSides) {
+void Algo::setCellWall(cellindex cell, byte direction, bool isWall) {
+    unsigned int version = Maze::getVersion();
     Maze::setWall(cell, direction, isWall);
+    if (CORRIDOR_GRAPH && isWall) {
+        Corridors::addWall(cell, direction, version);
+    }
     static char directionChars[] = {'n', 'e', 's', 'w'};
-    if (isWall) {
+    if (isWall && !HEADLESS) {
         API::setWall(Maze::getX(cell), Maze::getY(cell), directionChars[direction]);
     }
-    if (bothSides && hasNeighboringCell(cell, direction)) {
-        byte neighboringCell = getNeighboringCell(cell, direction);
-        setCellWall(neighboringCell, getOppositeDirection(direction), isWall, false);
-    }
 }
 
-void Algo::unsetCellWall(byte cell, byte direction, bool bothSides) {
-    Maze::clearWall(cell, direction);
+void Algo::eraseCellWall(cellindex cell, byte direction) {
     static char directionChars[] = {'n', 'e', 's', 'w'};
     API::clearWall(Maze::getX(cell), Maze::getY(cell), directionChars[direction]);
-    if (bothSides && hasNeighboringCell(cell, direction)) {
-        byte neighboringCell = getNeighboringCell(cell, direction);
-        unsetCellWall(neighboringCell, getOppositeDirection(direction), false);
-    }
 }
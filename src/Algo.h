@@ -1,28 +1,135 @@
 #pragma once
 
+#include <type_traits>
+
+#include "Bitboard.h"
+#include "BucketQueue.h"
 #include "Byte.h"
+#include "CostModel.h"
 #include "Direction.h"
 #include "Heap.h"
 #include "Maze.h"
+#include "MotionProfile.h"
+#include "Segment.h"
 
 class Algo {
 
 public:
 
+    Algo();
+
+    // Replaces the parameters of the cost model (see CostParameters), e.g.,
+    // to tune them. Takes effect at the next call to solve().
+    void setCostParameters(const CostParameters& parameters);
+    static CostParameters getDefaultCostParameters();
+
     void solve();
 
 private:
 
     static const bool FAST_STRAIGHT_AWAYS = true;
 
+    // The cost model used by the planner, unless given other parameters
+    typedef std::conditional<
+        FAST_STRAIGHT_AWAYS, FastStraightAways, FlatCosts
+    >::type CostModel;
+
+    // Whether or not to use a BucketQueue, rather than the (binary) Heap, as
+    // the frontier of Dijkstra's algo. The two settle cells of equal distance
+    // in different orders, so they may choose different (but equally fast)
+    // paths. See the --frontier option of the benchmark.
+    static const bool BUCKET_QUEUE = false;
+    typedef std::conditional<BUCKET_QUEUE, BucketQueue, Heap>::type Frontier;
+
+    // Whether or not generatePath should use A* rather than Dijkstra's algo,
+    // i.e., order the frontier by distance plus a lower bound on the distance
+    // left to the goals: the number of cells to the goals' bounding box, with
+    // a turn for any cell that isn't in line with it, each at the cheapest
+    // cost of such a move. Like the BucketQueue, it may break ties between
+    // equally fast paths differently (see the expansions stat).
+    static const bool A_STAR = false;
+
+    // Whether or not to keep a distance field rooted at the destination in
+    // the planner info of the Maze across steps, and only repair the cells
+    // affected by newly learned walls, rather than running Dijkstra from
+    // scratch every step
+    static const bool INCREMENTAL_PLANNING = false;
+
+    // Whether or not the incremental planner should keep a field rooted at
+    // each destination, the center and the origin (see Fields), repairing
+    // both as walls are learned, rather than rebuilding its one field every
+    // time the mouse turns around. Only applies with INCREMENTAL_PLANNING.
+    static const bool DUAL_FIELDS = false;
+
+    // Whether or not to skip all visualization (cell text, colors, walls, and
+    // movement logging), which keeps string formatting and I/O out of the hot
+    // path entirely. Useful for batch runs and on-robot builds.
+    static const bool HEADLESS = false;
+
+    // Whether or not to print the final distance grid to stderr at the end
+    // of each episode (i.e., when the destination is reached, or we give up)
+    static const bool DUMP_DISTANCES = false;
+
+    // Whether or not to replan fully known paths (i.e., speed runs) over the
+    // edge midpoints of the maze, so that staircases become diagonals, and
+    // to weigh them by time according to the mouse's MotionProfile
+    static const bool DIAGONAL_PLANNING = false;
+
+    // Whether or not generatePath should search the Corridors view of the
+    // maze rather than every cell, i.e., jump straight through corridors and
+    // skip over dead ends. The distances are the same either way, but ties
+    // may be broken differently, since fewer cells pass through the frontier,
+    // which changes the routes taken in some mazes. It pays off in known
+    // mazes, but while exploring, unknown walls are assumed absent, so few
+    // cells are corridors, and it saves little (see the benchmark).
+    static const bool CORRIDOR_GRAPH = false;
+
+    // Whether or not to remember the last few paths planned by generatePath
+    // (see PathCache), so that planning a path that was already planned with
+    // the same walls, such as the return trip to the origin, is just a copy
+    static const bool CACHE_PATHS = true;
+
+    // Whether or not to overlap planning with motion: the last move of each
+    // step is sent without waiting for it to complete, and the next step's
+    // path is planned from the cell that the mouse is moving into, assuming
+    // (as always) that its unknown walls are absent. If the walls read on
+    // arrival are indeed absent, the path stands; otherwise it's replanned.
+    // This only applies to generatePath, since the incremental field is
+    // repaired in place, and is already cheap to keep up to date.
+    static const bool SPECULATIVE_PLANNING = false;
+
+    // Whether or not to keep exploring after first reaching the center, by
+    // visiting only those cells whose unknown walls could still make for a
+    // shorter path, until the shortest known path is provably the shortest
+    // possible one. The mouse then returns to the origin, makes a single
+    // speed run to the center, and stops.
+    static const bool TARGETED_EXPLORATION = false;
+
     byte m_x; // X position of the mouse
     byte m_y; // Y position of the mouse
     byte m_d; // Direction of the mouse
     byte m_mode; // Modus operandi of the mouse
     byte m_initialDirection; // As the name states
+    bool m_fieldValid; // Whether the incremental distance field is usable
+    byte m_fieldMode; // The mode whose destination that field is rooted at
+    bool m_updatingStoredField; // Whether the field isn't the one shown
+    bool m_explored; // Whether the shortest path is known to be optimal
+    bool m_speculated; // Whether a path was planned before reading the walls
+    CostTable<Maze::MAX_LENGTH> m_costs; // Of the cost model, tabulated
 
     bool shouldColorVisitedCells() const;
     byte colorVisitedCellsDelayMs() const;
+    bool shouldBufferCommands() const;
+    bool shouldPrintFlushCount() const;
+    bool shouldReadWallsTogether() const;
+    bool shouldUseBinaryProtocol() const;
+    const char* getSimulatorSocketPath() const;
+    bool shouldRecordTrace() const;
+    const char* getTracePath() const;
+    bool shouldPersistSnapshot() const;
+    const char* getSnapshotPath() const;
+    bool shouldPrintStats() const;
+    bool shouldPrintStatsAsJson() const;
 
     bool resetButtonPressed();
     void acknowledgeResetButtonPressed();
@@ -33,43 +140,66 @@ private:
     void reset();
     void step();
 
-    byte generatePath(byte start);
-    void drawPath(byte start);
-    void followPath(byte start);
-    byte getFirstUnknown(byte start);
-
-    void checkNeighbor(byte cell, byte direction);
-    byte reverseLinkedList(byte cell);
+    cellindex generatePath(cellindex start);
+    void drawPath(cellindex start);
+    void followPath(cellindex start);
+    bool canSpeculate(cellindex next);
+    void speculate(cellindex start);
+    twobyte compilePath(cellindex start, Segment* segments);
+    void followSegments(const Segment* segments, twobyte numSegments);
+    void planDiagonals(cellindex start, const Bitboard& destinations);
+
+    void explore(cellindex start);
+    bool getExplorationTargets(Bitboard* targets);
+    cellindex getFirstUnknown(cellindex start);
+
+    bool updateField(cellindex start);
+    void buildField();
+    void repairField(cellindex cell, byte data);
+    void expandField();
+
+    void setEstimates();
+    void checkNeighbor(cellindex cell, byte direction);
+    void raiseEstimate(cellindex cell, cellindex neighbor);
+    void checkCorridor(cellindex cell, byte direction, cellindex start);
+    cellindex reverseLinkedList(cellindex cell);
 
     bool inCenter(byte x, byte y);
     bool inOrigin(byte x, byte y);
 
+    void getCenter(Bitboard* center);
+    void getDestinations(Bitboard* destinations);
+    void setGoals(const Bitboard& goals);
+    void drawKnownWalls();
     void colorCenter(char color);
+    void dumpDistances();
+    void drawDistances();
     void resetDestinationCellDistances();
-    byte getClosestDestinationCell();
+    cellindex getClosestDestinationCell();
 
     byte getOppositeDirection(byte direction);
-    bool hasNeighboringCell(byte cell, byte direction);
-    byte getNeighboringCell(byte cell, byte direction);
+    bool hasNeighboringCell(cellindex cell, byte direction);
+    cellindex getNeighboringCell(cellindex cell, byte direction);
 
-    bool isOneCellAway(byte target);
-    void moveOneCell(byte target);
+    bool isOneCellAway(cellindex target);
+    void moveOneCell(cellindex target, bool wait = true);
 
-    void readWalls();
+    byte readWalls();
     bool readWall(byte direction);
 
     void turnLeftUpdateState();
     void turnRightUpdateState();
     void turnAroundUpdateState();
-    void moveForwardUpdateState();
+    void moveForwardUpdateState(byte distance = 1);
 
-    void moveForward();
-    void leftAndForward();
-    void rightAndForward();
-    void aroundAndForward();
+    void moveForward(bool wait = true);
+    void leftAndForward(bool wait = true);
+    void rightAndForward(bool wait = true);
+    void aroundAndForward(bool wait = true);
+    void sendMoveForward(bool wait);
 
-    void setCellDistance(byte cell, twobyte distance);
-    void setCellWall(byte cell, byte direction, bool isWall, bool bothSides = true);
-    void unsetCellWall(byte cell, byte direction, bool bothSides = true);
+    void setCellDistance(cellindex cell, twobyte distance);
+    void setCellWall(cellindex cell, byte direction, bool isWall);
+    void eraseCellWall(cellindex cell, byte direction);
 
 };
@@ -0,0 +1,43 @@
+#include "Assert.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#define OPENING "---------- Assertion failed! ----------"
+#define CLOSING "---------------------------------------"
+
+THREAD_LOCAL int Assert::m_fault = 0;
+
+// Failures are written to stderr directly, rather than through std::cerr,
+// so that they're reported even when the algorithm's logging is muted (as
+// it is by the benchmark and the replayer)
+void Assert::fail(const char* file, int line, const char* condition) {
+    std::fprintf(
+        stderr,
+        OPENING "\nFILE: %s\nLINE: %d\nCOND: %s\n" CLOSING "\n",
+        file, line, condition
+    );
+    exit(1);
+}
+
+void Assert::fail(
+        const char* file,
+        int line,
+        const char* condition,
+        long long lhs,
+        long long rhs) {
+    std::fprintf(
+        stderr,
+        OPENING "\nFILE: %s\nLINE: %d\nCOND: %s\nLHS: %lld\nRHS: %lld\n" CLOSING "\n",
+        file, line, condition, lhs, rhs
+    );
+    exit(1);
+}
+
+int Assert::fault() {
+    return m_fault;
+}
+
+void Assert::clearFault() {
+    m_fault = 0;
+}
@@ -1,55 +1,87 @@
 #pragma once
 
-#include <cstdlib>
+#include "ThreadLocal.h"
 
-#include <iostream>
-#include <string>
+// The assertion policy, which is chosen at build time:
+//
+//   ASSERT_DEBUG    Print the failed condition (and operands) and exit(1)
+//   ASSERT_RELEASE  Compile the checks out, but let the optimizer assume them
+//   ASSERT_FAULT    Record a fault code (the line of the most recent failure)
+//                   without branching, for the robot to report as it sees fit
+//
+// The default is ASSERT_DEBUG, or ASSERT_RELEASE with -DNDEBUG. To choose
+// explicitly, pass e.g. -DASSERT_POLICY=ASSERT_FAULT.
+#define ASSERT_DEBUG 0
+#define ASSERT_RELEASE 1
+#define ASSERT_FAULT 2
 
-#define OPENING "---------- Assertion failed! ----------"
-#define CLOSING "---------------------------------------"
+#ifndef ASSERT_POLICY
+#ifdef NDEBUG
+#define ASSERT_POLICY ASSERT_RELEASE
+#else
+#define ASSERT_POLICY ASSERT_DEBUG
+#endif
+#endif
+
+class Assert {
+
+public:
+
+    // Reports a failed assertion to stderr, and exits (ASSERT_DEBUG). This
+    // lives out of line, so that only Assert.cpp needs to include cstdio.
+    [[noreturn]] static void fail(const char* file, int line, const char* condition);
+    [[noreturn]] static void fail(
+        const char* file,
+        int line,
+        const char* condition,
+        long long lhs,
+        long long rhs);
+
+    // The line of the most recent failed assertion, or 0 (ASSERT_FAULT)
+    static int fault();
+    static void clearFault();
+
+    static THREAD_LOCAL int m_fault;
+
+};
+
+#if ASSERT_POLICY == ASSERT_DEBUG
 
 #define ASSERT_TR(condition)\
 if (!(condition)) {\
-    std::cerr << OPENING << std::endl\
-              << "FILE: " <<  __FILE__  << std::endl\
-              << "LINE: " <<  __LINE__  << std::endl\
-              << "COND: " << #condition << std::endl\
-              << CLOSING << std::endl;\
-    exit(1);\
+    Assert::fail(__FILE__, __LINE__, #condition);\
 }
 
-#define ASSERT_EQ(lhs, rhs)\
-if (!((lhs) == (rhs))) {\
-    std::cerr << OPENING << std::endl\
-              << "FILE: " <<  __FILE__  << std::endl\
-              << "LINE: " <<  __LINE__  << std::endl\
-              << "COND: " << #lhs << " == " << #rhs << std::endl\
-              << "LHS: " << lhs << std::endl\
-              << "RHS: " << rhs << std::endl\
-              << CLOSING << std::endl;\
-    exit(1);\
+#define ASSERT_OP(lhs, op, rhs)\
+if (!((lhs) op (rhs))) {\
+    Assert::fail(__FILE__, __LINE__, #lhs " " #op " " #rhs,\
+        static_cast<long long>(lhs), static_cast<long long>(rhs));\
 }
 
-#define ASSERT_NE(lhs, rhs)\
-if (!((lhs) != (rhs))) {\
-    std::cerr << OPENING << std::endl\
-              << "FILE: " <<  __FILE__  << std::endl\
-              << "LINE: " <<  __LINE__  << std::endl\
-              << "COND: " << #lhs << " != " << #rhs << std::endl\
-              << "LHS: " << lhs << std::endl\
-              << "RHS: " << rhs << std::endl\
-              << CLOSING << std::endl;\
-    exit(1);\
-}
+#elif ASSERT_POLICY == ASSERT_RELEASE
 
-#define ASSERT_LT(lhs, rhs)\
-if (!((lhs) < (rhs))) {\
-    std::cerr << OPENING << std::endl\
-              << "FILE: " <<  __FILE__  << std::endl\
-              << "LINE: " <<  __LINE__  << std::endl\
-              << "COND: " << #lhs << " < " << #rhs << std::endl\
-              << "LHS: " << lhs << std::endl\
-              << "RHS: " << rhs << std::endl\
-              << CLOSING << std::endl;\
-    exit(1);\
-}
+#if defined(__clang__)
+#define ASSERT_TR(condition) __builtin_assume(condition)
+#elif defined(__GNUC__)
+#define ASSERT_TR(condition) do { if (!(condition)) __builtin_unreachable(); } while (0)
+#else
+#define ASSERT_TR(condition) do {} while (0)
+#endif
+
+#define ASSERT_OP(lhs, op, rhs) ASSERT_TR((lhs) op (rhs))
+
+#elif ASSERT_POLICY == ASSERT_FAULT
+
+// A conditional move rather than a branch
+#define ASSERT_TR(condition)\
+    (Assert::m_fault = (condition) ? Assert::m_fault : __LINE__)
+
+#define ASSERT_OP(lhs, op, rhs) ASSERT_TR((lhs) op (rhs))
+
+#else
+#error "Unknown ASSERT_POLICY"
+#endif
+
+#define ASSERT_EQ(lhs, rhs) ASSERT_OP(lhs, ==, rhs)
+#define ASSERT_NE(lhs, rhs) ASSERT_OP(lhs, !=, rhs)
+#define ASSERT_LT(lhs, rhs) ASSERT_OP(lhs, <, rhs)
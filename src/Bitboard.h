@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Bits.h"
+#include "Byte.h"
+#include "Maze.h"
+
+// A set of cells, laid out just like the wall bitboards in Maze: bit x of
+// row y is the cell (x, y). Row-wise operations on these are just a handful
+// of shifts, ands, and ors per row word (plus a carry from word to word, for
+// mazes wider than a single word).
+struct Bitboard {
+
+    static const twobyte NUM_WORDS = Maze::MAX_HEIGHT * Maze::ROW_WORDS;
+
+    rowword words[NUM_WORDS];
+
+    void clear();
+    bool any() const;
+    twobyte count() const;
+
+    bool get(cellindex cell) const;
+    void set(cellindex cell);
+
+};
+
+inline void Bitboard::clear() {
+    for (twobyte i = 0; i < NUM_WORDS; i += 1) {
+        words[i] = 0;
+    }
+}
+
+inline bool Bitboard::any() const {
+    rowword any = 0;
+    for (twobyte i = 0; i < NUM_WORDS; i += 1) {
+        any |= words[i];
+    }
+    return any != 0;
+}
+
+inline twobyte Bitboard::count() const {
+    twobyte count = 0;
+    for (twobyte i = 0; i < NUM_WORDS; i += 1) {
+        count += Bits::popCount(words[i]);
+    }
+    return count;
+}
+
+inline bool Bitboard::get(cellindex cell) const {
+    byte x = Maze::getX(cell);
+    byte y = Maze::getY(cell);
+    rowword word = words[y * Maze::ROW_WORDS + x / Maze::WORD_BITS];
+    return (word >> (x % Maze::WORD_BITS)) & 1;
+}
+
+inline void Bitboard::set(cellindex cell) {
+    byte x = Maze::getX(cell);
+    byte y = Maze::getY(cell);
+    words[y * Maze::ROW_WORDS + x / Maze::WORD_BITS] |=
+        static_cast<rowword>(1) << (x % Maze::WORD_BITS);
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "Byte.h"
+
+struct Bits {
+
+    // The smallest number of bits needed to represent n distinct values
+    static constexpr byte log2Ceil(twobyte n) {
+        return n <= 1 ? 0 : 1 + log2Ceil((n + 1) / 2);
+    }
+
+    // The number of set bits in a word
+    static byte popCount(unsigned long long word) {
+        return __builtin_popcountll(word);
+    }
+
+};
@@ -0,0 +1,172 @@
+#include "BucketQueue.h"
+
+#include "Assert.h"
+#include "Maze.h"
+#include "Stats.h"
+
+THREAD_LOCAL cellindex BucketQueue::m_size = 0;
+THREAD_LOCAL twobyte BucketQueue::m_cursor = 0;
+THREAD_LOCAL twobyte BucketQueue::m_overflowMin = 0;
+THREAD_LOCAL twobyte BucketQueue::m_head[] = {0};
+THREAD_LOCAL twobyte BucketQueue::m_next[] = {0};
+THREAD_LOCAL twobyte BucketQueue::m_prev[] = {0};
+THREAD_LOCAL unsigned long long BucketQueue::m_occupied[] = {0};
+THREAD_LOCAL twobyte BucketQueue::m_bucket[] = {0};
+
+cellindex BucketQueue::size() {
+    return m_size;
+}
+
+bool BucketQueue::contains(cellindex cell) {
+    return m_bucket[cell] != 0;
+}
+
+void BucketQueue::push(cellindex cell) {
+    ASSERT_TR(!contains(cell));
+    Stats::count(Stats::HEAP_PUSHES);
+    if (m_size == 0) {
+        // Each search starts afresh, from whatever priorities it's seeded with
+        m_cursor = 0;
+        m_overflowMin = Maze::MAX_PRIORITY;
+        for (twobyte i = 0; i <= RING; i += 1) {
+            m_head[i] = SENTINEL;
+        }
+    }
+    link(cell);
+    m_size += 1;
+}
+
+void BucketQueue::update(cellindex cell) {
+    ASSERT_TR(contains(cell));
+    Stats::count(Stats::HEAP_UPDATES);
+    twobyte priority = Maze::getPriority(cell);
+    twobyte bucket = getBucketIndex(priority);
+    if (bucket != m_bucket[cell] - 1) {
+        unlink(cell);
+        link(cell);
+    }
+    else if (bucket == OVERFLOW_BUCKET && priority < m_overflowMin) {
+        // Still beyond the window, but perhaps no longer the furthest beyond
+        // it, so the overflow bucket may have to be drained sooner
+        m_overflowMin = priority;
+    }
+}
+
+cellindex BucketQueue::pop() {
+    ASSERT_LT(0, m_size);
+    Stats::count(Stats::HEAP_POPS);
+
+    // Move any overflowed cells that the window has caught up with into the
+    // ring, or if the ring is empty, jump the window ahead to them
+    if (m_head[OVERFLOW_BUCKET] != SENTINEL) {
+        if (findOccupiedBucket(m_cursor % RING) == SENTINEL) {
+            m_cursor = Maze::MAX_PRIORITY;
+            for (twobyte cell = m_head[OVERFLOW_BUCKET]; cell != SENTINEL; cell = m_next[cell]) {
+                if (Maze::getPriority(cell) < m_cursor) {
+                    m_cursor = Maze::getPriority(cell);
+                }
+            }
+            drainOverflow();
+        }
+        else if (m_overflowMin < m_cursor + RING) {
+            drainOverflow();
+        }
+    }
+
+    // The first nonempty bucket at or after the cursor holds the minimum
+    twobyte bucket = findOccupiedBucket(m_cursor % RING);
+    ASSERT_NE(bucket, SENTINEL);
+    m_cursor += (bucket - m_cursor % RING + RING) % RING;
+    cellindex cell = m_head[bucket];
+    ASSERT_EQ(Maze::getPriority(cell), m_cursor);
+    unlink(cell);
+    m_size -= 1;
+    return cell;
+}
+
+void BucketQueue::clear() {
+    for (twobyte i = 0; i <= RING && 0 < m_size; i += 1) {
+        for (twobyte cell = m_head[i]; cell != SENTINEL; cell = m_next[cell]) {
+            m_bucket[cell] = 0;
+            m_size -= 1;
+        }
+    }
+    for (twobyte i = 0; i < RING_WORDS; i += 1) {
+        m_occupied[i] = 0;
+    }
+    ASSERT_EQ(m_size, 0);
+}
+
+twobyte BucketQueue::getBucketIndex(twobyte priority) {
+    // Relaxations never lower a priority below that of the last cell popped
+    ASSERT_TR(m_cursor <= priority);
+    if (priority - m_cursor < RING) {
+        return priority % RING;
+    }
+    return OVERFLOW_BUCKET;
+}
+
+twobyte BucketQueue::findOccupiedBucket(twobyte from) {
+    // Search the words of the bitmap in ring order, starting with the bits
+    // at or after the given bucket, and ending with the bits before it
+    twobyte word = from / 64;
+    unsigned long long bits = m_occupied[word] & (~0ULL << (from % 64));
+    for (twobyte i = 0; i <= RING_WORDS; i += 1) {
+        if (bits != 0) {
+            return word * 64 + __builtin_ctzll(bits);
+        }
+        word = (word + 1) % RING_WORDS;
+        bits = m_occupied[word];
+    }
+    return SENTINEL;
+}
+
+void BucketQueue::link(cellindex cell) {
+    twobyte priority = Maze::getPriority(cell);
+    twobyte bucket = getBucketIndex(priority);
+    m_prev[cell] = SENTINEL;
+    m_next[cell] = m_head[bucket];
+    if (m_head[bucket] != SENTINEL) {
+        m_prev[m_head[bucket]] = cell;
+    }
+    m_head[bucket] = cell;
+    m_bucket[cell] = bucket + 1;
+    if (bucket == OVERFLOW_BUCKET) {
+        if (priority < m_overflowMin) {
+            m_overflowMin = priority;
+        }
+    }
+    else {
+        m_occupied[bucket / 64] |= 1ULL << (bucket % 64);
+    }
+}
+
+void BucketQueue::unlink(cellindex cell) {
+    twobyte bucket = m_bucket[cell] - 1;
+    if (m_prev[cell] != SENTINEL) {
+        m_next[m_prev[cell]] = m_next[cell];
+    }
+    else {
+        m_head[bucket] = m_next[cell];
+    }
+    if (m_next[cell] != SENTINEL) {
+        m_prev[m_next[cell]] = m_prev[cell];
+    }
+    if (bucket != OVERFLOW_BUCKET && m_head[bucket] == SENTINEL) {
+        m_occupied[bucket / 64] &= ~(1ULL << (bucket % 64));
+    }
+    m_bucket[cell] = 0;
+}
+
+void BucketQueue::drainOverflow() {
+    // Relink every overflowed cell (again), which files those within the
+    // window into the ring, and recomputes the bound for the rest
+    twobyte cell = m_head[OVERFLOW_BUCKET];
+    m_head[OVERFLOW_BUCKET] = SENTINEL;
+    m_overflowMin = Maze::MAX_PRIORITY;
+    while (cell != SENTINEL) {
+        twobyte next = m_next[cell];
+        link(cell);
+        cell = next;
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Byte.h"
+#include "Maze.h"
+#include "ThreadLocal.h"
+
+class BucketQueue {
+
+    // A drop-in alternative to the (binary) Heap for Dijkstra's algo, which
+    // exploits the fact that the planner's costs are small integers (Dial's
+    // algo). Since each relaxation adds at most one edge cost to the distance
+    // of the cell being settled, every cell in the queue lies within a window
+    // of distances just past the last one popped. The window is a ring of
+    // buckets, one per distance, and a bitmap of the nonempty buckets lets
+    // pop() skip over the empty ones a word at a time. Pushes and updates
+    // are O(1), and so are pops, amortized over the window.
+    //
+    // The exceptions are the incremental field's repair, which seeds the queue
+    // with cells of arbitrary distances, and A*, whose estimates can raise a
+    // cell's priority (see Maze::getPriority()) by more than an edge cost.
+    // Cells beyond the window wait in an overflow bucket, and are moved into
+    // the ring once it reaches them.
+
+public:
+
+    static cellindex size();
+    static bool contains(cellindex cell);
+    static void push(cellindex cell);
+    static void update(cellindex cell);
+    static cellindex pop();
+    static void clear();
+
+private:
+
+    // Enough buckets for any single edge cost (i.e., a turn, or the first
+    // cell of a straightaway), plus the overflow bucket
+    static const twobyte RING = 512;
+    static const twobyte OVERFLOW_BUCKET = RING;
+    static const twobyte RING_WORDS = RING / 64;
+
+    // Each bucket is a doubly linked list of cells. The links are twobytes
+    // (which, despite the name, are unsigned ints) rather than cellindexes,
+    // since a one-byte cellindex has no spare value for the sentinel.
+    static const twobyte SENTINEL = static_cast<twobyte>(-1);
+
+    static THREAD_LOCAL cellindex m_size;
+
+    // A lower bound on the priorities in the queue (the last one popped), and
+    // on those in the overflow bucket
+    static THREAD_LOCAL twobyte m_cursor;
+    static THREAD_LOCAL twobyte m_overflowMin;
+
+    static THREAD_LOCAL twobyte m_head[RING + 1];
+    static THREAD_LOCAL twobyte m_next[Maze::MAX_CELLS];
+    static THREAD_LOCAL twobyte m_prev[Maze::MAX_CELLS];
+    static THREAD_LOCAL unsigned long long m_occupied[RING_WORDS];
+
+    // For each cell, one more than the index of its bucket, or 0 if the cell
+    // isn't in the queue (so that zero-initialization means an empty queue)
+    static THREAD_LOCAL twobyte m_bucket[Maze::MAX_CELLS];
+
+    static twobyte getBucketIndex(twobyte priority);
+    static twobyte findOccupiedBucket(twobyte from);
+
+    static void link(cellindex cell);
+    static void unlink(cellindex cell);
+    static void drainOverflow();
+};
@@ -0,0 +1,134 @@
+#include "Corridors.h"
+
+#include <cstring>
+
+#include "Assert.h"
+
+THREAD_LOCAL bool Corridors::m_valid = false;
+THREAD_LOCAL unsigned int Corridors::m_version = 0;
+THREAD_LOCAL unsigned long long Corridors::m_goal[] = {0};
+THREAD_LOCAL unsigned long long Corridors::m_corridor[] = {0};
+THREAD_LOCAL unsigned long long Corridors::m_pruned[] = {0};
+THREAD_LOCAL byte Corridors::m_exit[] = {0};
+THREAD_LOCAL byte Corridors::m_degree[] = {0};
+THREAD_LOCAL cellindex Corridors::m_leaves[] = {0};
+THREAD_LOCAL twobyte Corridors::m_numLeaves = 0;
+
+void Corridors::invalidate() {
+    m_valid = false;
+}
+
+void Corridors::update() {
+    if (
+        m_valid &&
+        m_version == Maze::getVersion() &&
+        std::memcmp(m_goal, Maze::m_goal, sizeof(m_goal)) == 0
+    ) {
+        return;
+    }
+    rebuild();
+}
+
+void Corridors::addWall(cellindex cell, byte direction, unsigned int version) {
+
+    // If the view was already stale, or the wall was already there, or
+    // anything else has changed, then there's nothing to update (and in the
+    // first case, update() will rebuild the view anyway)
+    if (!m_valid || m_version != version || Maze::getVersion() != version + 1) {
+        return;
+    }
+    m_version = Maze::getVersion();
+    if (!Maze::hasNeighbor(cell, direction)) {
+        return;
+    }
+    cellindex neighbor = Maze::getNeighbor(cell, direction);
+    updateCorridor(cell);
+    updateCorridor(neighbor);
+
+    // Cells that were part of the rest of the maze lose a way out, and may
+    // become dead ends. Otherwise, the wall is within (or at the edge of) a
+    // dead end subtree, and may cut part of it off.
+    bool cellPruned = isPruned(cell);
+    bool neighborPruned = isPruned(neighbor);
+    if (!cellPruned && !neighborPruned) {
+        m_degree[cell] -= 1;
+        m_degree[neighbor] -= 1;
+        considerPruning(cell);
+        considerPruning(neighbor);
+        prune();
+        return;
+    }
+    if (cellPruned && m_exit[cell] == direction) {
+        m_exit[cell] = NO_EXIT;
+    }
+    if (neighborPruned && m_exit[neighbor] == (direction + 2) % 4) {
+        m_exit[neighbor] = NO_EXIT;
+    }
+}
+
+void Corridors::rebuild() {
+    std::memcpy(m_goal, Maze::m_goal, sizeof(m_goal));
+    std::memset(m_corridor, 0, sizeof(m_corridor));
+    std::memset(m_pruned, 0, sizeof(m_pruned));
+    for (byte x = 0; x < Maze::getWidth(); x += 1) {
+        for (byte y = 0; y < Maze::getHeight(); y += 1) {
+            cellindex cell = Maze::getCell(x, y);
+            updateCorridor(cell);
+            m_degree[cell] = __builtin_popcount(Maze::getOpenDirections(cell));
+        }
+    }
+
+    // Fill in the dead ends, one by one
+    m_numLeaves = 0;
+    for (byte x = 0; x < Maze::getWidth(); x += 1) {
+        for (byte y = 0; y < Maze::getHeight(); y += 1) {
+            considerPruning(Maze::getCell(x, y));
+        }
+    }
+    prune();
+    m_version = Maze::getVersion();
+    m_valid = true;
+}
+
+void Corridors::updateCorridor(cellindex cell) {
+    static const byte NORTH_SOUTH = 1 << Direction::NORTH | 1 << Direction::SOUTH;
+    static const byte EAST_WEST = 1 << Direction::EAST | 1 << Direction::WEST;
+    byte openDirections = Maze::getOpenDirections(cell);
+    setBit(m_corridor, cell, (
+        !Maze::isGoal(cell) &&
+        (openDirections == NORTH_SOUTH || openDirections == EAST_WEST)
+    ));
+}
+
+void Corridors::considerPruning(cellindex cell) {
+    if (isPruned(cell) || Maze::isGoal(cell) || 1 < m_degree[cell]) {
+        return;
+    }
+    setBit(m_pruned, cell, true);
+    m_leaves[m_numLeaves] = cell;
+    m_numLeaves += 1;
+}
+
+void Corridors::prune() {
+    while (0 < m_numLeaves) {
+        m_numLeaves -= 1;
+        cellindex cell = m_leaves[m_numLeaves];
+
+        // The exit is the one open side that doesn't lead further into the
+        // dead end, if there still is one, and the cell there loses a way out
+        m_exit[cell] = NO_EXIT;
+        byte openDirections = Maze::getOpenDirections(cell);
+        for (byte direction = 0; direction < 4; direction += 1) {
+            if (!((openDirections >> direction) & 1)) {
+                continue;
+            }
+            cellindex neighbor = Maze::getNeighbor(cell, direction);
+            if (!isPruned(neighbor)) {
+                ASSERT_EQ(m_exit[cell], NO_EXIT);
+                m_exit[cell] = direction;
+                m_degree[neighbor] -= 1;
+                considerPruning(neighbor);
+            }
+        }
+    }
+}
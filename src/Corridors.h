@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Byte.h"
+#include "Maze.h"
+#include "ThreadLocal.h"
+
+class Corridors {
+
+    // The Corridors class is a coarser view of the maze for Dijkstra's algo,
+    // derived from the walls (with unknown walls assumed absent) and the
+    // goals. It marks two kinds of cells that the search can skip over:
+    //
+    //   - Corridor cells, which are open on exactly two opposite sides, so
+    //     that any path through one goes straight through. A search that
+    //     enters a corridor can jump to the cell at its far end, since the
+    //     cost of the whole run is known from the straightaway length.
+    //
+    //   - Pruned cells, which make up the dead end subtrees of the maze, i.e.,
+    //     the cells that would become dead ends if the dead ends were filled
+    //     in one by one. No path to a goal enters one, unless it starts in
+    //     one, in which case it takes each cell's exit on the way out.
+    //
+    // Goal cells are neither. The view is kept up to date incrementally as
+    // walls are added (see addWall()), and is rebuilt from scratch whenever
+    // else the walls or goals have changed (see update()).
+
+public:
+
+    // The exit of a pruned cell that is cut off from the rest of the maze
+    static const byte NO_EXIT = 4;
+
+    // Forces a rebuild at the next call to update()
+    static void invalidate();
+
+    // Rebuilds the view if the walls or the goals have changed since it was
+    // last brought up to date
+    static void update();
+
+    // Updates the view for a wall that was just added, given the version of
+    // the maze from right before it was (see Maze::getVersion())
+    static void addWall(cellindex cell, byte direction, unsigned int version);
+
+    static bool isCorridor(cellindex cell);
+    static bool isPruned(cellindex cell);
+    static byte getExit(cellindex cell);
+
+private:
+
+    static THREAD_LOCAL bool m_valid;
+    static THREAD_LOCAL unsigned int m_version;
+    static THREAD_LOCAL unsigned long long m_goal[Maze::PLANE_WORDS];
+    static THREAD_LOCAL unsigned long long m_corridor[Maze::PLANE_WORDS];
+    static THREAD_LOCAL unsigned long long m_pruned[Maze::PLANE_WORDS];
+
+    // For each cell, its exit (if pruned), and the number of its open sides
+    // that lead to cells that aren't pruned
+    static THREAD_LOCAL byte m_exit[Maze::MAX_CELLS];
+    static THREAD_LOCAL byte m_degree[Maze::MAX_CELLS];
+
+    // The cells that have been pruned, but whose exits haven't been found
+    static THREAD_LOCAL cellindex m_leaves[Maze::MAX_CELLS];
+    static THREAD_LOCAL twobyte m_numLeaves;
+
+    static void rebuild();
+    static void updateCorridor(cellindex cell);
+    static void considerPruning(cellindex cell);
+    static void prune();
+    static void setBit(unsigned long long* plane, cellindex cell, bool value);
+    static bool getBit(const unsigned long long* plane, cellindex cell);
+
+};
+
+inline bool Corridors::isCorridor(cellindex cell) {
+    return getBit(m_corridor, cell);
+}
+
+inline bool Corridors::isPruned(cellindex cell) {
+    return getBit(m_pruned, cell);
+}
+
+inline byte Corridors::getExit(cellindex cell) {
+    return m_exit[cell];
+}
+
+inline void Corridors::setBit(unsigned long long* plane, cellindex cell, bool value) {
+    unsigned long long bit = 1ULL << (cell % 64);
+    if (value) {
+        plane[cell / 64] |= bit;
+    }
+    else {
+        plane[cell / 64] &= ~bit;
+    }
+}
+
+inline bool Corridors::getBit(const unsigned long long* plane, cellindex cell) {
+    return (plane[cell / 64] >> (cell % 64)) & 1;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Byte.h"
+
+// The parameters of a cost model: a turn costs turnCost, and the n-th cell of
+// a straightaway costs straightAwayCost / n, but no less than
+// minStraightAwayCost (e.g., once the mouse has reached its top speed). Each
+// cost must be between 1 and 256, so that every distance is at most
+// Maze::MAX_DISTANCE, and thus fits in a celldistance.
+struct CostParameters {
+    twobyte turnCost;
+    twobyte straightAwayCost;
+    twobyte minStraightAwayCost;
+};
+
+// A cost model that prefers long straightaways: a turn costs as much as
+// moving a single cell, but each cell of a straightaway is cheaper than the
+// one before it, since the mouse can accelerate along the straightaway
+struct FastStraightAways {
+    static constexpr CostParameters parameters() {
+        return {256, 256, 1};
+    }
+};
+
+// A cost model that charges the same amount for every straight move
+struct FlatCosts {
+    static constexpr CostParameters parameters() {
+        return {2, 3, 3};
+    }
+};
+
+// The costs of a cost model, with the straightaway costs tabulated by
+// straightaway length, so that the planner never has to compute them
+template <byte MAX_LENGTH>
+struct CostTable {
+
+    twobyte turnCost;
+    twobyte straightAwayCost[MAX_LENGTH + 1];
+    twobyte minCost; // Of any single move
+
+    constexpr explicit CostTable(const CostParameters& parameters) :
+        turnCost(parameters.turnCost), straightAwayCost(),
+        minCost(parameters.turnCost) {
+        for (twobyte length = 1; length <= MAX_LENGTH; length += 1) {
+            twobyte cost = parameters.straightAwayCost / length;
+            straightAwayCost[length] = (
+                cost < parameters.minStraightAwayCost ?
+                parameters.minStraightAwayCost : cost
+            );
+            if (straightAwayCost[length] < minCost) {
+                minCost = straightAwayCost[length];
+            }
+        }
+    }
+
+};
@@ -0,0 +1,282 @@
+#include "Diagonal.h"
+
+#include "Assert.h"
+
+THREAD_LOCAL std::vector<float> Diagonal::m_time;
+THREAD_LOCAL std::vector<float> Diagonal::m_run;
+THREAD_LOCAL std::vector<unsigned int> Diagonal::m_previous;
+THREAD_LOCAL unsigned int Diagonal::m_size = 0;
+THREAD_LOCAL std::vector<unsigned int> Diagonal::m_heap;
+THREAD_LOCAL std::vector<unsigned int> Diagonal::m_position;
+
+float Diagonal::plan(
+        cellindex start,
+        byte direction,
+        const Bitboard& goal,
+        const MotionProfile& profile) {
+
+    static const float INFINITE_TIME = 1e30;
+    static const float HALF_DIAGONAL = 0.70710678;
+
+    // Reset the arrival times of all nodes, growing the tables if the maze
+    // is larger than any planned for on this thread so far
+    unsigned int numNodes = getNumNodes();
+    if (m_time.size() < numNodes) {
+        m_time.resize(numNodes);
+        m_run.resize(numNodes);
+        m_previous.resize(numNodes);
+        m_heap.resize(numNodes);
+        m_position.resize(numNodes);
+    }
+    for (unsigned int node = 0; node < numNodes; node += 1) {
+        m_time[node] = INFINITE_TIME;
+        m_position[node] = 0;
+    }
+    m_size = 0;
+
+    // The first move is half of a cell, from the center of the start cell to
+    // one of its edges, possibly after pivoting in place
+    for (byte exit = 0; exit < 4; exit += 1) {
+        if (!Maze::isKnown(start, exit) || Maze::isWall(start, exit)) {
+            continue;
+        }
+        byte quarterTurns = (exit - direction + 4) % 4;
+        float pivotTime = (quarterTurns == 0 ? 0 : quarterTurns == 2 ? 2 : 1) *
+            profile.pivotTime;
+        relax(
+            getNode(Maze::getNeighbor(start, exit), exit, 0),
+            SENTINEL,
+            pivotTime + profile.runTime(0.5, false),
+            0.5
+        );
+    }
+
+    // Dijkstra's algo, over the edge midpoints
+    unsigned int destination = SENTINEL;
+    while (0 < m_size) {
+        unsigned int node = pop();
+        cellindex cell = getNodeCell(node);
+        if (goal.get(cell)) {
+            destination = node;
+            break;
+        }
+
+        byte crossing = getNodeDirection(node);
+        byte heading = getNodeHeading(node);
+        for (byte exit = 0; exit < 4; exit += 1) {
+
+            // Never double back, and only use walls known to be absent
+            if (exit == (crossing + 2) % 4) {
+                continue;
+            }
+            if (!Maze::isKnown(cell, exit) || Maze::isWall(cell, exit)) {
+                continue;
+            }
+
+            // Determine the heading of the move, and the kind of node it
+            // leads to, relative to the edge that it crosses
+            byte nextHeading = 2 * crossing;
+            byte kind = 0;
+            if (exit == (crossing + 1) % 4) {
+                nextHeading = (2 * crossing + 1) % 8;
+                kind = 2;
+            }
+            else if (exit == (crossing + 3) % 4) {
+                nextHeading = (2 * crossing + 7) % 8;
+                kind = 1;
+            }
+
+            // Either continue the current run, or change heading and start
+            // a new run at turn speed. The turn itself covers the first half
+            // diagonal of the new heading, so that turning 90 degrees within
+            // a cell is priced as two 45 degree turns.
+            bool diagonal = nextHeading % 2 == 1;
+            float length = diagonal ? HALF_DIAGONAL : 1.0;
+            byte change = getHeadingChange(heading, nextHeading);
+            float time = m_time[node];
+            float run = 0;
+            if (change == 0) {
+                run = m_run[node] + length;
+                time +=
+                    profile.runTime(run, diagonal) -
+                    profile.runTime(m_run[node], diagonal);
+            }
+            else {
+                run = diagonal ? 0 : length;
+                time += profile.turnTime[change] + profile.runTime(run, diagonal);
+            }
+            relax(getNode(Maze::getNeighbor(cell, exit), exit, kind), node, time, run);
+        }
+    }
+    if (destination == SENTINEL) {
+        return -1;
+    }
+
+    // Walk back from the destination to collect the cells of the route,
+    // making sure that the route never passes through the same cell twice
+    // (since each cell has only a single "next" pointer)
+    static THREAD_LOCAL unsigned int route[Maze::MAX_CELLS];
+    twobyte length = 0;
+    Bitboard visited;
+    visited.clear();
+    visited.set(start);
+    for (unsigned int node = destination; node != SENTINEL; node = m_previous[node]) {
+        cellindex cell = getNodeCell(node);
+        if (visited.get(cell)) {
+            return -1;
+        }
+        visited.set(cell);
+        route[length] = node;
+        length += 1;
+    }
+
+    // Record the route in the "next" pointers
+    cellindex current = start;
+    for (twobyte i = length; 0 < i; i -= 1) {
+        Maze::setNextDirection(current, getNodeDirection(route[i - 1]));
+        current = getNodeCell(route[i - 1]);
+    }
+    Maze::clearNext(current);
+
+    return m_time[destination];
+}
+
+float Diagonal::estimate(
+        cellindex start,
+        byte direction,
+        const MotionProfile& profile) {
+
+    float time = 0;
+    float run = 0;
+    byte heading = direction;
+    bool first = true;
+    cellindex current = start;
+    while (Maze::hasNext(current)) {
+        byte next = Maze::getNextDirection(current);
+        byte quarterTurns = (next - heading + 4) % 4;
+        if (first) {
+            // Pivot in place, then move from the center to the edge
+            time += (quarterTurns == 0 ? 0 : quarterTurns == 2 ? 2 : 1) *
+                profile.pivotTime;
+            run = 0.5;
+            first = false;
+        }
+        else if (quarterTurns == 0) {
+            run += 1;
+        }
+        else {
+            // Finish the run, and then turn within the cell
+            time += profile.runTime(run, false) + (
+                quarterTurns == 2 ? 2 * profile.pivotTime : profile.turnTime[2]
+            );
+            run = 0;
+        }
+        heading = next;
+        current = Maze::getNeighbor(current, next);
+    }
+    return time + profile.runTime(run, false);
+}
+
+unsigned int Diagonal::getNumNodes() {
+    // Moves never leave the maze, since its perimeter walls are always known
+    cellindex last = Maze::getCell(Maze::getWidth() - 1, Maze::getHeight() - 1);
+    return getNode(last, 3, KINDS - 1) + 1;
+}
+
+unsigned int Diagonal::getNode(cellindex cell, byte direction, byte kind) {
+    return (cell * 4 + direction) * KINDS + kind;
+}
+
+cellindex Diagonal::getNodeCell(unsigned int node) {
+    return node / KINDS / 4;
+}
+
+byte Diagonal::getNodeDirection(unsigned int node) {
+    return node / KINDS % 4;
+}
+
+byte Diagonal::getNodeHeading(unsigned int node) {
+    static const byte OFFSETS[] = {0, 1, 7};
+    return (2 * getNodeDirection(node) + OFFSETS[node % KINDS]) % 8;
+}
+
+byte Diagonal::getHeadingChange(byte from, byte to) {
+    byte change = (to - from + 8) % 8;
+    return change <= 4 ? change : 8 - change;
+}
+
+void Diagonal::relax(
+        unsigned int node,
+        unsigned int previous,
+        float time,
+        float run) {
+    if (time < m_time[node]) {
+        m_time[node] = time;
+        m_run[node] = run;
+        m_previous[node] = previous;
+        if (m_position[node] == 0) {
+            push(node);
+        }
+        else {
+            heapifyUp(m_position[node] - 1);
+        }
+    }
+}
+
+void Diagonal::push(unsigned int node) {
+    ASSERT_LT(m_size, NUM_NODES);
+    place(m_size, node);
+    m_size += 1;
+    heapifyUp(m_size - 1);
+}
+
+unsigned int Diagonal::pop() {
+    ASSERT_LT(0, m_size);
+    unsigned int node = m_heap[0];
+    m_position[node] = 0;
+    m_size -= 1;
+    if (0 < m_size) {
+        place(0, m_heap[m_size]);
+        heapifyDown(0);
+    }
+    return node;
+}
+
+void Diagonal::heapifyUp(unsigned int index) {
+    while (0 < index) {
+        unsigned int parent = (index - 1) / 2;
+        if (!(m_time[m_heap[index]] < m_time[m_heap[parent]])) {
+            break;
+        }
+        unsigned int temp = m_heap[index];
+        place(index, m_heap[parent]);
+        place(parent, temp);
+        index = parent;
+    }
+}
+
+void Diagonal::heapifyDown(unsigned int index) {
+    while (true) {
+        unsigned int left = index * 2 + 1;
+        unsigned int right = left + 1;
+        unsigned int smallest = index;
+        if (left < m_size && m_time[m_heap[left]] < m_time[m_heap[smallest]]) {
+            smallest = left;
+        }
+        if (right < m_size && m_time[m_heap[right]] < m_time[m_heap[smallest]]) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            break;
+        }
+        unsigned int temp = m_heap[index];
+        place(index, m_heap[smallest]);
+        place(smallest, temp);
+        index = smallest;
+    }
+}
+
+void Diagonal::place(unsigned int index, unsigned int node) {
+    m_heap[index] = node;
+    m_position[node] = index + 1;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+
+#include "Bitboard.h"
+#include "Byte.h"
+#include "Maze.h"
+#include "MotionProfile.h"
+#include "ThreadLocal.h"
+
+class Diagonal {
+
+    // The Diagonal class plans speed runs for a mouse that can cut corners.
+    // Rather than cells, the nodes of its graph are the midpoints of the
+    // edges between cells, so that each move is either an orthogonal move
+    // across a cell (from one edge to the opposite edge) or a diagonal half
+    // move (from one edge to an adjacent edge). A node is identified by the
+    // cell being entered, the direction in which the edge is crossed, and
+    // the heading of the move that crossed it (one of eight, in 45 degree
+    // increments). Moves are weighted by the time they take, according to
+    // a MotionProfile, taking into account acceleration along straightaways
+    // and diagonals, and the time spent changing heading.
+
+public:
+
+    // Plans the fastest route from the start cell, where the mouse faces
+    // the given direction, to any of the goal cells, using only walls known
+    // to be absent. The cells of the route are recorded in the "next"
+    // pointers of the maze. Returns the estimated time in seconds, or a
+    // negative value if there is no such route.
+    static float plan(
+        cellindex start,
+        byte direction,
+        const Bitboard& goal,
+        const MotionProfile& profile);
+
+    // Estimates the time, in seconds, that it takes to drive the path of
+    // "next" pointers from the start cell without cutting any corners
+    static float estimate(
+        cellindex start,
+        byte direction,
+        const MotionProfile& profile);
+
+private:
+
+    // Each node has one of three kinds of heading: orthogonal to the edge it
+    // crosses, or diagonal, 45 degrees clockwise or counterclockwise of that
+    static const byte KINDS = 3;
+    static const unsigned int NUM_NODES = Maze::MAX_CELLS * 4 * KINDS;
+    static const unsigned int SENTINEL = NUM_NODES;
+
+    // The number of nodes of the actual maze, rather than of the storage
+    static unsigned int getNumNodes();
+
+    static unsigned int getNode(cellindex cell, byte direction, byte kind);
+    static cellindex getNodeCell(unsigned int node);
+    static byte getNodeDirection(unsigned int node);
+    static byte getNodeHeading(unsigned int node);
+    static byte getHeadingChange(byte from, byte to);
+
+    // The arrival time at each node, the length of the straightaway or
+    // diagonal that ends at the node, and the previous node on the route.
+    // With twelve nodes per cell, these are by far the largest of the
+    // planner's tables, so rather than being sized for the storage, they're
+    // allocated by plan(), for the actual maze, and only if it's ever used.
+    static THREAD_LOCAL std::vector<float> m_time;
+    static THREAD_LOCAL std::vector<float> m_run;
+    static THREAD_LOCAL std::vector<unsigned int> m_previous;
+
+    // A binary min-heap of nodes ordered by arrival time, with a position
+    // table (one more than the index, or 0 if absent) for decrease-key
+    static THREAD_LOCAL unsigned int m_size;
+    static THREAD_LOCAL std::vector<unsigned int> m_heap;
+    static THREAD_LOCAL std::vector<unsigned int> m_position;
+
+    static void relax(
+        unsigned int node,
+        unsigned int previous,
+        float time,
+        float run);
+    static void push(unsigned int node);
+    static unsigned int pop();
+    static void heapifyUp(unsigned int index);
+    static void heapifyDown(unsigned int index);
+    static void place(unsigned int index, unsigned int node);
+
+};
@@ -0,0 +1,32 @@
+#include "Fields.h"
+
+#include <algorithm>
+
+THREAD_LOCAL bool Fields::m_valid = false;
+THREAD_LOCAL celldistance Fields::m_distance[Maze::MAX_CELLS];
+THREAD_LOCAL byte Fields::m_straightAwayLength[Maze::MAX_CELLS];
+THREAD_LOCAL byte Fields::m_nextDirection[Maze::MAX_CELLS];
+THREAD_LOCAL unsigned long long Fields::m_discovered[Maze::PLANE_WORDS];
+THREAD_LOCAL unsigned long long Fields::m_hasNext[Maze::PLANE_WORDS];
+
+void Fields::clear() {
+    m_valid = false;
+}
+
+bool Fields::isValid() {
+    return m_valid;
+}
+
+bool Fields::swap(bool valid) {
+    // Only the cells of the actual maze are in use
+    twobyte numCells = Maze::getCell(Maze::getWidth() - 1, Maze::getHeight() - 1) + 1;
+    std::swap_ranges(m_distance, m_distance + numCells, Maze::m_distance);
+    std::swap_ranges(
+        m_straightAwayLength, m_straightAwayLength + numCells, Maze::m_straightAwayLength
+    );
+    std::swap_ranges(m_nextDirection, m_nextDirection + numCells, Maze::m_nextDirection);
+    std::swap_ranges(m_discovered, m_discovered + Maze::PLANE_WORDS, Maze::m_discovered);
+    std::swap_ranges(m_hasNext, m_hasNext + Maze::PLANE_WORDS, Maze::m_hasNext);
+    std::swap(m_valid, valid);
+    return valid;
+}
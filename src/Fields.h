@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Byte.h"
+#include "Maze.h"
+#include "ThreadLocal.h"
+
+class Fields {
+
+    // The Fields class holds a second distance field for the incremental
+    // planner, so that it can keep one rooted at each of its destinations (the
+    // center and the origin) rather than rebuilding its one field every time
+    // it turns around. The field in use lives in the planner info of the Maze,
+    // as always, and the other one waits here, along with whether it's valid,
+    // until the two are swapped. That's the same 1088 B again for a 16 x 16
+    // maze, and swapping, rather than copying, the two costs a pass over each.
+
+public:
+
+    // Forgets the stored field, e.g., when the walls are rolled back
+    static void clear();
+
+    // Whether the stored field is usable, which it isn't until it has been
+    // swapped out of the Maze as a valid field
+    static bool isValid();
+
+    // Exchanges the field in the planner info of the Maze, whose validity is
+    // given, with the stored one, whose validity is returned
+    static bool swap(bool valid);
+
+private:
+
+    static THREAD_LOCAL bool m_valid;
+    static THREAD_LOCAL celldistance m_distance[Maze::MAX_CELLS];
+    static THREAD_LOCAL byte m_straightAwayLength[Maze::MAX_CELLS];
+    static THREAD_LOCAL byte m_nextDirection[Maze::MAX_CELLS];
+    static THREAD_LOCAL unsigned long long m_discovered[Maze::PLANE_WORDS];
+    static THREAD_LOCAL unsigned long long m_hasNext[Maze::PLANE_WORDS];
+
+};
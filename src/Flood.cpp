@@ -0,0 +1,159 @@
+#include "Flood.h"
+
+void Flood::board(Bitboard* board) {
+    board->clear();
+    for (byte y = 0; y < Maze::getHeight(); y += 1) {
+        for (byte x = 0; x < Maze::getWidth(); x += 1) {
+            board->set(Maze::getCell(x, y));
+        }
+    }
+}
+
+void Flood::reachable(const Bitboard& from, bool optimistic, Bitboard* reached) {
+    Bitboard all;
+    board(&all);
+    Bitboard frontier = from;
+    *reached = from;
+    Bitboard next;
+    do {
+        expand(frontier, optimistic, &next);
+        frontier = next;
+    } while (advance(all, &frontier, reached));
+}
+
+bool Flood::canReach(cellindex from, const Bitboard& goal, bool optimistic) {
+    Bitboard all;
+    board(&all);
+    Bitboard frontier;
+    frontier.clear();
+    frontier.set(from);
+    Bitboard visited = frontier;
+    Bitboard next;
+    do {
+        rowword hit = 0;
+        for (twobyte i = 0; i < Bitboard::NUM_WORDS; i += 1) {
+            hit |= frontier.words[i] & goal.words[i];
+        }
+        if (hit) {
+            return true;
+        }
+        expand(frontier, optimistic, &next);
+        frontier = next;
+    } while (advance(all, &frontier, &visited));
+    return false;
+}
+
+twobyte Flood::countUnknown(const Bitboard& cells) {
+    Bitboard found;
+    unknown(cells, &found);
+    return found.count();
+}
+
+void Flood::unknown(const Bitboard& cells, Bitboard* unknown) {
+
+    // The walls on the perimeter of the storage aren't stored, but are known
+    static const byte R = Maze::ROW_WORDS;
+    static const byte WB = Maze::WORD_BITS;
+    static const rowword ALL = static_cast<rowword>(~static_cast<rowword>(0));
+    static const byte EAST_WORD = (Maze::MAX_WIDTH - 1) / WB;
+    static const rowword EAST_EDGE =
+        static_cast<rowword>(1) << ((Maze::MAX_WIDTH - 1) % WB);
+
+    for (byte y = 0; y < Maze::MAX_HEIGHT; y += 1) {
+        for (byte w = 0; w < R; w += 1) {
+            twobyte i = y * R + w;
+            rowword north = (y < Maze::MAX_HEIGHT - 1 ? Maze::m_horizontalKnown[i] : ALL);
+            rowword south = (0 < y ? Maze::m_horizontalKnown[i - R] : ALL);
+            rowword east = Maze::m_verticalKnown[i] | (w == EAST_WORD ? EAST_EDGE : 0);
+            rowword west = static_cast<rowword>(Maze::m_verticalKnown[i] << 1) | (
+                0 < w ? Maze::m_verticalKnown[i - 1] >> (WB - 1) : 1
+            );
+            unknown->words[i] = ~(north & south & east & west) & cells.words[i];
+        }
+    }
+}
+
+void Flood::distances(const Bitboard& goal, bool optimistic, twobyte* distances) {
+
+    for (twobyte cell = 0; cell < Maze::MAX_CELLS; cell += 1) {
+        distances[cell] = UNREACHABLE;
+    }
+
+    Bitboard all;
+    board(&all);
+    Bitboard frontier = goal;
+    Bitboard visited = goal;
+    Bitboard next;
+    twobyte distance = 0;
+    do {
+        // Label the cells of the frontier, one set bit at a time
+        for (byte y = 0; y < Maze::MAX_HEIGHT; y += 1) {
+            for (byte w = 0; w < Maze::ROW_WORDS; w += 1) {
+                rowword word = frontier.words[y * Maze::ROW_WORDS + w];
+                while (word) {
+                    byte bit = __builtin_ctzll(word);
+                    word &= word - 1;
+                    distances[Maze::getCell(w * Maze::WORD_BITS + bit, y)] = distance;
+                }
+            }
+        }
+        expand(frontier, optimistic, &next);
+        frontier = next;
+        distance += 1;
+    } while (advance(all, &frontier, &visited));
+}
+
+void Flood::expand(const Bitboard& frontier, bool optimistic, Bitboard* next) {
+
+    static const byte R = Maze::ROW_WORDS;
+    static const byte WB = Maze::WORD_BITS;
+
+    next->clear();
+    for (byte y = 0; y < Maze::MAX_HEIGHT; y += 1) {
+        for (byte w = 0; w < R; w += 1) {
+
+            twobyte i = y * R + w;
+            rowword cells = frontier.words[i];
+            rowword vertical = Maze::m_verticalWalls[i];
+            rowword horizontal = Maze::m_horizontalWalls[i];
+            if (!optimistic) {
+                vertical |= ~Maze::m_verticalKnown[i];
+                horizontal |= ~Maze::m_horizontalKnown[i];
+            }
+
+            // East: cell x moves to x + 1 if there's no wall on its east side,
+            // carrying the top bit into the next word of the row
+            rowword east = cells & ~vertical;
+            next->words[i] |= static_cast<rowword>(east << 1);
+            if (w + 1 < R) {
+                next->words[i + 1] |= east >> (WB - 1);
+            }
+
+            // West: cell x + 1 moves to x if there's no wall on x's east side
+            rowword west = (cells >> 1) | (
+                w + 1 < R ? static_cast<rowword>(frontier.words[i + 1] << (WB - 1)) : 0
+            );
+            next->words[i] |= west & ~vertical;
+
+            // North: cell y moves to y + 1 if there's no wall on its north side
+            if (y < Maze::MAX_HEIGHT - 1) {
+                next->words[i + R] |= cells & ~horizontal;
+            }
+
+            // South: cell y + 1 moves to y if there's no wall on y's north side
+            if (y < Maze::MAX_HEIGHT - 1) {
+                next->words[i] |= frontier.words[i + R] & ~horizontal;
+            }
+        }
+    }
+}
+
+bool Flood::advance(const Bitboard& board, Bitboard* next, Bitboard* visited) {
+    rowword any = 0;
+    for (twobyte i = 0; i < Bitboard::NUM_WORDS; i += 1) {
+        next->words[i] &= board.words[i] & ~visited->words[i];
+        visited->words[i] |= next->words[i];
+        any |= next->words[i];
+    }
+    return any != 0;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Bitboard.h"
+#include "Byte.h"
+#include "Maze.h"
+
+class Flood {
+
+    // The Flood class performs breadth-first searches of the whole maze
+    // using bitboards, so that each step of the wavefront is computed for
+    // every cell at once. Unknown walls are either assumed to be absent
+    // (optimistic) or assumed to be present (pessimistic).
+
+public:
+
+    // The distance of cells that can't be reached at all
+    static const twobyte UNREACHABLE = Maze::MAX_CELLS;
+
+    // Retrieves all cells within the actual maze size
+    static void board(Bitboard* board);
+
+    // Retrieves all cells reachable from the given set of cells
+    static void reachable(const Bitboard& from, bool optimistic, Bitboard* reached);
+
+    // Whether or not any of the goal cells is reachable from the given cell
+    static bool canReach(cellindex from, const Bitboard& goal, bool optimistic);
+
+    // The number of the given cells that have at least one unknown wall
+    static twobyte countUnknown(const Bitboard& cells);
+
+    // Retrieves those of the given cells that have at least one unknown wall
+    static void unknown(const Bitboard& cells, Bitboard* unknown);
+
+    // Computes the number of moves from every cell to the nearest goal cell
+    // (or UNREACHABLE), i.e., the classic Micromouse flood fill values
+    static void distances(const Bitboard& goal, bool optimistic, twobyte* distances);
+
+private:
+
+    // Retrieves the cells one move away from the frontier
+    static void expand(const Bitboard& frontier, bool optimistic, Bitboard* next);
+
+    // Removes the visited cells from next, and returns whether any remain
+    static bool advance(const Bitboard& board, Bitboard* next, Bitboard* visited);
+
+};
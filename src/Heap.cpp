@@ -2,40 +2,46 @@
 
 #include "Assert.h"
 #include "Maze.h"
+#include "Stats.h"
 
-byte Heap::m_size = 0;
-byte Heap::m_data[] = {0};
+THREAD_LOCAL cellindex Heap::m_size = 0;
+THREAD_LOCAL cellindex Heap::m_data[] = {0};
+THREAD_LOCAL cellindex Heap::m_position[] = {0};
 
-byte Heap::size() {
+cellindex Heap::size() {
     return m_size;
 }
 
-void Heap::push(byte cell) {
+bool Heap::contains(cellindex cell) {
+    return m_position[cell] != 0;
+}
+
+void Heap::push(cellindex cell) {
     ASSERT_LT(m_size, CAPACITY);
-    m_data[m_size] = cell;
+    ASSERT_TR(!contains(cell));
+    Stats::count(Stats::HEAP_PUSHES);
+    place(m_size, cell);
     m_size += 1;
     if (1 < m_size) {
         heapifyUp(m_size - 1);
     }
 }
 
-void Heap::update(byte cell) {
-    byte index = SENTINEL;
-    for (byte i = 0; i < m_size; i += 1) {
-        if (m_data[i] == cell) {
-            index = i;
-            break;
-        }
-    }
-    ASSERT_NE(index, SENTINEL);
-    heapifyUp(index);
+void Heap::update(cellindex cell) {
+    ASSERT_TR(contains(cell));
+    Stats::count(Stats::HEAP_UPDATES);
+    heapifyUp(m_position[cell] - 1);
 }
 
-byte Heap::pop() {
+cellindex Heap::pop() {
     ASSERT_LT(0, m_size);
-    byte cell = m_data[0];
-    m_data[0] = m_data[m_size - 1];
+    Stats::count(Stats::HEAP_POPS);
+    cellindex cell = m_data[0];
+    m_position[cell] = 0;
     m_size -= 1;
+    if (0 < m_size) {
+        place(0, m_data[m_size]);
+    }
     if (1 < m_size) {
         heapifyDown(0);
     }
@@ -43,33 +49,36 @@ byte Heap::pop() {
 }
 
 void Heap::clear() {
+    for (cellindex i = 0; i < m_size; i += 1) {
+        m_position[m_data[i]] = 0;
+    }
     m_size = 0;
 }
 
-byte Heap::getParentIndex(byte index) {
+cellindex Heap::getParentIndex(cellindex index) {
     if (index == 0) {
         return SENTINEL;
     }
     return (index - 1) / 2;
 }
 
-byte Heap::getLeftChildIndex(byte index) {
+cellindex Heap::getLeftChildIndex(cellindex index) {
     if (getParentIndex(CAPACITY - 1) < index) {
         return SENTINEL;
     }
     return (index * 2) + 1;
 }
 
-byte Heap::getRightChildIndex(byte index) {
+cellindex Heap::getRightChildIndex(cellindex index) {
     if (getParentIndex(CAPACITY - 1) < index) {
         return SENTINEL;
     }
     return (index + 1) * 2;
 }
 
-byte Heap::getMinChildIndex(byte index) {
-    byte left = getLeftChildIndex(index);
-    byte right = getRightChildIndex(index);
+cellindex Heap::getMinChildIndex(cellindex index) {
+    cellindex left = getLeftChildIndex(index);
+    cellindex right = getRightChildIndex(index);
     if (m_size <= left) {
         return SENTINEL;
     }
@@ -77,17 +86,17 @@ byte Heap::getMinChildIndex(byte index) {
         return left;
     }
     return (
-        Maze::getDistance(m_data[left]) < Maze::getDistance(m_data[right]) ?
+        Maze::getPriority(m_data[left]) < Maze::getPriority(m_data[right]) ?
         left : right
     );
 }
 
-void Heap::heapifyUp(byte index) {
+void Heap::heapifyUp(cellindex index) {
     ASSERT_LT(index, m_size);
-    byte parentIndex = getParentIndex(index);
+    cellindex parentIndex = getParentIndex(index);
     while (
         parentIndex != SENTINEL &&
-        Maze::getDistance(m_data[index]) < Maze::getDistance(m_data[parentIndex])
+        Maze::getPriority(m_data[index]) < Maze::getPriority(m_data[parentIndex])
     ) {
         swap(index, parentIndex);
         index = parentIndex;
@@ -95,12 +104,12 @@ void Heap::heapifyUp(byte index) {
     }
 }
 
-void Heap::heapifyDown(byte index) {
+void Heap::heapifyDown(cellindex index) {
     ASSERT_LT(index, m_size);
-    byte minChildIndex = getMinChildIndex(index);
+    cellindex minChildIndex = getMinChildIndex(index);
     while (
         minChildIndex != SENTINEL &&
-        Maze::getDistance(m_data[minChildIndex]) < Maze::getDistance(m_data[index])
+        Maze::getPriority(m_data[minChildIndex]) < Maze::getPriority(m_data[index])
     ) {
         swap(index, minChildIndex);
         index = minChildIndex;
@@ -108,11 +117,16 @@ void Heap::heapifyDown(byte index) {
     }
 }
 
-void Heap::swap(byte indexOne, byte indexTwo) {
+void Heap::swap(cellindex indexOne, cellindex indexTwo) {
     ASSERT_LT(indexOne, m_size);
     ASSERT_LT(indexTwo, m_size);
     ASSERT_NE(indexOne, indexTwo);
-    byte temp = m_data[indexOne];
-    m_data[indexOne] = m_data[indexTwo];
-    m_data[indexTwo] = temp;
+    cellindex temp = m_data[indexOne];
+    place(indexOne, m_data[indexTwo]);
+    place(indexTwo, temp);
+}
+
+void Heap::place(cellindex index, cellindex cell) {
+    m_data[index] = cell;
+    m_position[cell] = index + 1;
 }
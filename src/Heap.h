@@ -1,31 +1,40 @@
 #pragma once
 
 #include "Byte.h"
+#include "Maze.h"
+#include "ThreadLocal.h"
 
 class Heap {
 
 public:
 
-    static byte size();
-    static void push(byte cell);
-    static void update(byte cell);
-    static byte pop();
+    static cellindex size();
+    static bool contains(cellindex cell);
+    static void push(cellindex cell);
+    static void update(cellindex cell);
+    static cellindex pop();
     static void clear();
 
 private:
 
-    static const byte CAPACITY = 127;
-    static const byte SENTINEL = 255;
+    // Enough room for the frontier of a search over half of the maze
+    static const cellindex CAPACITY = Maze::MAX_CELLS / 2 - 1;
+    static const cellindex SENTINEL = static_cast<cellindex>(-1);
 
-    static byte m_size;
-    static byte m_data[CAPACITY];
+    static THREAD_LOCAL cellindex m_size;
+    static THREAD_LOCAL cellindex m_data[CAPACITY];
 
-    static byte getParentIndex(byte index); 
-    static byte getLeftChildIndex(byte index); 
-    static byte getRightChildIndex(byte index); 
-    static byte getMinChildIndex(byte index);
+    // For each cell, one more than its index in m_data, or 0 if the cell
+    // isn't in the heap (so that zero-initialization means an empty heap)
+    static THREAD_LOCAL cellindex m_position[Maze::MAX_CELLS];
 
-    static void heapifyUp(byte index);
-    static void heapifyDown(byte index);
-    static void swap(byte indexOne, byte indexTwo);
+    static cellindex getParentIndex(cellindex index); 
+    static cellindex getLeftChildIndex(cellindex index); 
+    static cellindex getRightChildIndex(cellindex index); 
+    static cellindex getMinChildIndex(cellindex index);
+
+    static void heapifyUp(cellindex index);
+    static void heapifyDown(cellindex index);
+    static void swap(cellindex indexOne, cellindex indexTwo);
+    static void place(cellindex index, cellindex cell);
 };
@@ -2,44 +2,80 @@
 
 #include "Assert.h"
 
-byte History::m_size = 0;
-byte History::m_tail = 0;
-bool History::m_infoAdded = false;
-twobyte History::m_data[] = {0};
+THREAD_LOCAL twobyte History::m_size = 0;
+THREAD_LOCAL twobyte History::m_sinceCheckpoint = 0;
+THREAD_LOCAL twobyte History::m_tail = 0;
+THREAD_LOCAL bool History::m_infoAdded = false;
+THREAD_LOCAL unsigned int History::m_data[] = {0};
 
-byte History::size() {
+twobyte History::size() {
     return m_size;
 }
 
-void History::add(byte cell, byte data) {
-    m_data[m_tail] = cell << 8 | data;
-    m_infoAdded = true;
+void History::clear() {
+    m_size = 0;
+    m_sinceCheckpoint = 0;
+    m_tail = 0;
+    m_infoAdded = false;
 }
 
-void History::move() {
-    if (!m_infoAdded) {
-        m_data[m_tail] = 0;
+void History::add(cellindex cell, byte data) {
+
+    // Only remember cells where something was actually learned
+    if (data == 0) {
+        return;
     }
-    m_infoAdded = false;
+
+    // When full, the oldest entry (and possibly the checkpoint) is dropped
+    m_data[m_tail] = static_cast<unsigned int>(cell) << 8 | data;
     m_tail = (m_tail + 1) % CAPACITY;
     if (m_size < CAPACITY) {
-        m_size += 1; 
+        m_size += 1;
+    }
+    if (m_sinceCheckpoint < CAPACITY) {
+        m_sinceCheckpoint += 1;
+    }
+    m_infoAdded = true;
+}
+
+void History::move() {
+    m_infoAdded = false;
+}
+
+void History::checkpoint() {
+    m_sinceCheckpoint = 0;
+}
+
+unsigned int History::peek() {
+    return m_infoAdded ? m_data[(m_tail - 1 + CAPACITY) % CAPACITY] : 0;
+}
+
+twobyte History::rollback() {
+    ASSERT_TR(m_sinceCheckpoint <= m_size);
+    twobyte count = m_sinceCheckpoint;
+    m_tail = (m_tail - count + CAPACITY) % CAPACITY;
+    for (twobyte i = 0; i < count; i += 1) {
+        unsigned int cellAndData = undone(i);
+        for (byte direction = 0; direction < 4; direction += 1) {
+            if ((data(cellAndData) >> (direction + 4)) & 1) {
+                Maze::clearWall(cell(cellAndData), direction);
+            }
+        }
     }
+    m_size -= count;
+    m_sinceCheckpoint = 0;
+    m_infoAdded = false;
+    return count;
 }
 
-twobyte History::pop() {
-    ASSERT_LT(0, m_size);
-    m_tail = (m_tail - 1 + CAPACITY) % CAPACITY;
-    twobyte cellAndData = m_data[m_tail];
-    m_data[m_tail] = 0;
-    m_size -= 1;
-    return cellAndData;
+unsigned int History::undone(twobyte index) {
+    return m_data[(m_tail + index) % CAPACITY];
 }
 
-byte History::cell(twobyte cellAndData) {
+cellindex History::cell(unsigned int cellAndData) {
     return cellAndData >> 8;
 }
 
-byte History::data(twobyte cellAndData) {
+byte History::data(unsigned int cellAndData) {
     return cellAndData & 255;
 }
@@ -1,58 +1,77 @@
 #pragma once
 
 #include "Byte.h"
+#include "Maze.h"
+#include "ThreadLocal.h"
+
+// The maximum number of entries remembered by the History class. By default,
+// that's enough to remember every wall learned in the maze (since all of a
+// cell's walls are known once it's been visited, each cell has at most one
+// entry), but smaller values can be used to save memory, at the cost of
+// making older wall info permanent.
+#ifndef HISTORY_DEPTH
+#define HISTORY_DEPTH (MAX_MAZE_SIZE * MAX_MAZE_SIZE)
+#endif
 
 class History {
 
-    // The History class is a circular stack that remembers the previous
-    // CAPACITY moves, and allows you to retrieve the wall information learned
-    // by those moves. The proper way to use the History class is to call add()
-    // whenever new wall info has been learned, and to call move() whenever the
-    // mouse moves from one cell to the next. However, you should call add() at
-    // most once between calls to move(), and you should call move() at least
-    // once between calls to add(). This is because the History class assumes
-    // that, for every cell that the mouse travels, at most one cell's worth of
-    // wall information can be learned.
+    // The History class is a ring buffer of the wall information learned by
+    // the mouse, along with a checkpoint, so that everything learned since
+    // the last known-good point (e.g., since the mouse last safely reached
+    // its destination) can be forgotten all at once, such as when the mouse
+    // crashes and is reset. The proper way to use the History class is to
+    // call add() whenever new wall info has been learned, to call move()
+    // whenever the mouse moves from one cell to the next, and to call
+    // checkpoint() whenever the wall info learned so far is trusted.
 
 public:
 
-    static byte size();
-    static void add(byte cell, byte data);
+    static twobyte size();
+    static void clear();
+    static void add(cellindex cell, byte data);
     static void move();
-    static twobyte pop();
-    static byte cell(twobyte cellAndData);
-    static byte data(twobyte cellAndData);
+    static void checkpoint();
+
+    // The info from the most recent call to add(), or 0 if add() hasn't been
+    // called (with new wall info) since the most recent call to move()
+    static unsigned int peek();
+
+    // Forgets, in the maze, all of the walls learned since the most recent
+    // checkpoint (or as far back as is remembered), and returns the number
+    // of entries undone. Those entries remain available through undone(),
+    // oldest first, until the next call to add().
+    static twobyte rollback();
+    static unsigned int undone(twobyte index);
+
+    static cellindex cell(unsigned int cellAndData);
+    static byte data(unsigned int cellAndData);
 
 private:
 
-    // The maximum number of moves/cells remembered by the History class
-    static const byte CAPACITY = 16;
+    static const twobyte CAPACITY = HISTORY_DEPTH;
 
-    // The total number of moves currently remembered by the History class.
-    // It's value is essentially max(CAPACITY, count(move()) - count(pop())).
-    static byte m_size;
+    // The number of entries remembered, and the number since the checkpoint
+    static THREAD_LOCAL twobyte m_size;
+    static THREAD_LOCAL twobyte m_sinceCheckpoint;
 
-    // The location in m_data where the information from the next call to add()
-    // will be stored. This is incremented by move() and decremented by pop().
-    static byte m_tail;
+    // The location in m_data where the next entry will be stored
+    static THREAD_LOCAL twobyte m_tail;
 
     // Whether or not add() has been called following the most recent call to
-    // move(), which helps us to decide whether or not to explicitly overwrite
-    // some data the next time that move() is called.
-    static bool m_infoAdded;
+    // move(), which is what peek() reports
+    static THREAD_LOCAL bool m_infoAdded;
 
-    // One byte for the x and y position of the cell, and one byte for whether
-    // or not we learned of any walls, and what wall values we actually learned
-    // (which is technically not needed):
+    // The index of the cell in the high bits, and one byte for whether or not
+    // we learned of any walls, and what wall values we actually learned:
     //
-    //                 |---------|---------|---------|---------|
-    //            info |    x    |    y    | learned |  walls  |
-    //                 |---------|---------|---------|---------|
-    //         pos/dir |  00-15  |  00-15  | w s e n | w s e n |
-    //                 |---------|---------|---------|---------|
-    //            bits | 7 6 5 4 | 3 2 1 0 | 7 6 5 4 | 3 2 1 0 |
-    //                 |---------|---------|---------|---------|
+    //                 |-------------|---------|---------|
+    //            info |    cell     | learned |  walls  |
+    //                 |-------------|---------|---------|
+    //         pos/dir |  cellindex  | w s e n | w s e n |
+    //                 |-------------|---------|---------|
+    //            bits |   ... 9 8   | 7 6 5 4 | 3 2 1 0 |
+    //                 |-------------|---------|---------|
     //
-    static twobyte m_data[CAPACITY];
+    static THREAD_LOCAL unsigned int m_data[CAPACITY];
 
 };
@@ -1,74 +1,606 @@
 #pragma once
 
+#include <cstring>
+
 #include "Byte.h"
+#include "Bits.h"
 #include "Direction.h"
+#include "ThreadLocal.h"
 
-struct Info {
-    // The distance of the cell from the source (no units)
-    twobyte distance;
-    // bit 0 is whether or not the cell has been discovered
-    // bit 1 is whether or not the cell has a "next" cell
-    // bits 2 - 3 are the direction of the "next" cell
-    // bits 4 - 7 are the straightaway length
-    byte misc;
-};
+// The largest width and height supported by this build, which must be in
+// [1, 255]. The actual maze size is read from the API at startup. Builds for
+// mazes larger than 16 x 16 (e.g., -DMAX_MAZE_SIZE=32) need two-byte cell
+// indices, whereas the default build keeps them to a single byte.
+#ifndef MAX_MAZE_SIZE
+#define MAX_MAZE_SIZE 16
+#endif
+
+#if MAX_MAZE_SIZE < 1 || 255 < MAX_MAZE_SIZE
+#error "MAX_MAZE_SIZE must be in [1, 255]"
+#endif
+
+#if MAX_MAZE_SIZE <= 16
+typedef byte cellindex;
+#else
+typedef unsigned short cellindex;
+#endif
+
+// The type that the planner stores distances (and A*'s estimates) in, which
+// must hold MAX_DISTANCE. That's 16 * 16 * 256 - 1 = 65535 for the default
+// build, which just fits in two bytes, but not for larger mazes. Arithmetic
+// on distances (e.g., priorities, which add the estimates) is in twobyte.
+#if MAX_MAZE_SIZE <= 16
+typedef unsigned short celldistance;
+#else
+typedef unsigned int celldistance;
+#endif
+
+// The word type used for each row of the wall bitboards
+#if MAX_MAZE_SIZE <= 16
+typedef unsigned short rowword;
+#elif MAX_MAZE_SIZE <= 32
+typedef unsigned int rowword;
+#else
+typedef unsigned long long rowword;
+#endif
+
+template <byte W, byte H>
+struct BasicMaze {
+
+    // The width and height of the storage for the maze
+    static const byte MAX_WIDTH  = W;
+    static const byte MAX_HEIGHT = H;
+
+    // Cells are laid out in columns of STRIDE, the smallest power of two that
+    // fits MAX_HEIGHT, regardless of the actual height of the maze. Thus
+    // converting to and from xy coordinates is just shifts and masks.
+    static const byte SHIFT = Bits::log2Ceil(MAX_HEIGHT);
+    static const twobyte STRIDE = 1 << SHIFT;
+    static const twobyte MAX_CELLS = MAX_WIDTH * STRIDE;
+
+    // A distance larger than that of any path through the maze
+    static const twobyte MAX_DISTANCE = MAX_WIDTH * MAX_HEIGHT * 256 - 1;
+    static_assert(
+        MAX_DISTANCE <= static_cast<celldistance>(-1),
+        "celldistance must hold MAX_DISTANCE"
+    );
+
+    // A priority larger than that of any cell (see getPriority())
+    static const twobyte MAX_PRIORITY = MAX_DISTANCE + (MAX_WIDTH + MAX_HEIGHT) * 256;
 
-struct Maze {
+    // An upper bound on the length of any straightaway
+    static const byte MAX_LENGTH = MAX_WIDTH < MAX_HEIGHT ? MAX_HEIGHT : MAX_WIDTH;
 
-    // The width and height of the maze, as understood
-    // by the algorithm, both of which must be in [1, 16]
-    static const byte WIDTH  = 16;
-    static const byte HEIGHT = 16;
+    // Forgets all walls and planning info, as if the maze were brand new
+    static void clear();
+
+    // Sets the actual width and height of the maze, both of
+    // which must be in [1, MAX_WIDTH] and [1, MAX_HEIGHT]
+    static void setSize(byte width, byte height);
+    static byte getWidth();
+    static byte getHeight();
 
     // The x and y positions of the lower left and upper right center cells
-    static const byte CLLX = (WIDTH  - 1) / 2;
-    static const byte CLLY = (HEIGHT - 1) / 2;
-    static const byte CURX = (WIDTH     ) / 2;
-    static const byte CURY = (HEIGHT    ) / 2;
+    static byte getCLLX();
+    static byte getCLLY();
+    static byte getCURX();
+    static byte getCURY();
 
-    // For each cell, we store only eight bits of information: four bits for
-    // whether we know the value of a wall, and four bits for the actual value
+    // Each wall is shared by the two cells on either side of it, so we store
+    // it exactly once, in one of two sets of bitboards: the horizontal walls,
+    // where bit x of row y is the wall on the north side of cell (x, y), and
+    // the vertical walls, where bit x of row y is the wall on the east side of
+    // cell (x, y). Each set has two planes, one for whether or not we know the
+    // value of a wall, and one for the actual value (which is zero if unknown).
     //
-    //    info |  known  |  walls  |
-    //         |---------|---------|
-    //     dir | w s e n | w s e n |
-    //         |---------|---------|
-    //    bits | 7 6 5 4 | 3 2 1 0 |
+    //   horizontal |   y = H - 2   |  ...  |     y = 0     |
+    //              |---------------|-------|---------------|
+    //     vertical |   y = H - 1   |  ...  |     y = 0     |
+    //              |---------------|-------|---------------|
+    //         bits | ... x ... 1 0 |  ...  | ... x ... 1 0 |
     //
-    // Furthermore, each cell can be indexed by just eight bits: at most
-    // four bits for the x position, and at most four bits for the y position
-    //      
-    static byte m_data[WIDTH * HEIGHT];
+    // The walls on the perimeter of MAX_WIDTH x MAX_HEIGHT aren't stored at
+    // all, since they're always known to exist. The walls on the perimeter of
+    // the actual maze, if smaller, are stored just like any other wall.
+    static const byte WORD_BITS = 8 * sizeof(rowword);
+    static const byte ROW_WORDS = (MAX_WIDTH + WORD_BITS - 1) / WORD_BITS;
+    static THREAD_LOCAL rowword m_horizontalKnown[MAX_HEIGHT * ROW_WORDS];
+    static THREAD_LOCAL rowword m_horizontalWalls[MAX_HEIGHT * ROW_WORDS];
+    static THREAD_LOCAL rowword m_verticalKnown[MAX_HEIGHT * ROW_WORDS];
+    static THREAD_LOCAL rowword m_verticalWalls[MAX_HEIGHT * ROW_WORDS];
+
+    // A count of the changes to the walls that the planner can see, i.e., of
+    // the walls added or removed. Learning that a wall is absent doesn't
+    // count, since the planner assumes that unknown walls are absent anyway.
+    // Thus a path planned at one version is good for as long as it lasts.
+    static THREAD_LOCAL unsigned int m_version;
+    static unsigned int getVersion();
+
+    // The actual width and height of the maze
+    static THREAD_LOCAL byte m_width;
+    static THREAD_LOCAL byte m_height;
 
     // Helper methods for converting between xy coordinates
     // and the maze index of the cell in the data array
-    static byte getX(byte cell);
-    static byte getY(byte cell);
-    static byte getCell(byte x, byte y);
+    static byte getX(cellindex cell);
+    static byte getY(cellindex cell);
+    static cellindex getCell(byte x, byte y);
+
+    // The offset from the index of a cell to that of its neighbor, by direction
+    static const int OFFSETS[4];
+
+    // For each cell, a bitmask of the directions in which the cell has a
+    // neighboring cell (within the actual maze size), computed by setSize()
+    static THREAD_LOCAL byte m_neighbors[MAX_CELLS];
+
+    // Helper methods for finding neighboring cells. Note that getNeighbor()
+    // doesn't check that the neighbor exists, but since the perimeter walls
+    // are always known, every open direction is guaranteed to have one.
+    static bool hasNeighbor(cellindex cell, byte direction);
+    static cellindex getNeighbor(cellindex cell, byte direction);
+    static byte getOpenDirections(cellindex cell);
 
     // Helper methods for querying and updating maze data
     static bool isKnown(byte x, byte y, byte direction);
     static bool isWall(byte x, byte y, byte direction);
     static void setWall(byte x, byte y, byte direction, bool isWall);
     static void clearWall(byte x, byte y, byte direction);
-    static bool isKnown(byte cell, byte direction);
-    static bool isWall(byte cell, byte direction);
-    static void setWall(byte cell, byte direction, bool isWall);
-    static void clearWall(byte cell, byte direction);
-
-    // Information used only by Dijkstra's algo to determine the fastest path
-    static Info m_info[WIDTH * HEIGHT];
-
-    // Helper methods for accessing and modifying m_info
-    static twobyte getDistance(byte cell);
-    static void setDistance(byte cell, twobyte distance);
-    static bool getDiscovered(byte cell);
-    static void setDiscovered(byte cell, bool discovered);
-    static bool hasNext(byte cell);
-    static void clearNext(byte cell);
-    static byte getNextDirection(byte cell);
-    static void setNextDirection(byte cell, byte nextDirection);
-    static byte getStraightAwayLength(byte cell);
-    static void setStraightAwayLength(byte cell, byte straightAwayLength);
+    static bool isKnown(cellindex cell, byte direction);
+    static bool isWall(cellindex cell, byte direction);
+    static void setWall(cellindex cell, byte direction, bool isWall);
+    static void clearWall(cellindex cell, byte direction);
+
+    // Finds the planes and bit of the wall on the given side of the cell, or
+    // returns false if the wall is on the perimeter (and thus isn't stored)
+    static bool locateWall(
+        cellindex cell,
+        byte direction,
+        rowword** known,
+        rowword** walls,
+        rowword* bit);
+
+    // Information used only by Dijkstra's algo to determine the fastest path,
+    // laid out as a structure of arrays, so that each pass of the planner only
+    // touches the fields it needs: the distance of each cell from the source
+    // (no units), the length of the straightaway that ends at each cell, and
+    // the direction of its "next" cell, along with bit planes (indexed by
+    // cell) for whether each cell has been discovered and has a "next" cell.
+    // For a 16 x 16 maze, that's 512 B of distances, 256 B each of lengths
+    // and directions, and 32 B per bit plane (1088 B in all), and each bit
+    // plane can be reset with a single memset.
+    static const twobyte PLANE_WORDS = (MAX_CELLS + 63) / 64;
+    static THREAD_LOCAL celldistance m_distance[MAX_CELLS];
+    static THREAD_LOCAL byte m_straightAwayLength[MAX_CELLS];
+    static THREAD_LOCAL byte m_nextDirection[MAX_CELLS];
+    static THREAD_LOCAL unsigned long long m_discovered[PLANE_WORDS];
+    static THREAD_LOCAL unsigned long long m_hasNext[PLANE_WORDS];
+
+    // The cells that the planner is headed for, as another bit plane, so that
+    // Dijkstra's algo can tell whether it has settled one with a single test
+    static THREAD_LOCAL unsigned long long m_goal[PLANE_WORDS];
+
+    // For A*, a lower bound on the distance from each cell to the nearest
+    // goal, or zero for Dijkstra's algo. The frontiers order cells by their
+    // priority, which is the sum of the two. Another 512 B for 16 x 16. The
+    // estimates never exceed (MAX_WIDTH + MAX_HEIGHT) * 256, which fits too.
+    static THREAD_LOCAL celldistance m_estimate[MAX_CELLS];
+
+    // Helper methods for accessing and modifying the planner info
+    static void clearAllDiscovered();
+    static void clearAllNext();
+    static void clearAllGoals();
+    static bool isGoal(cellindex cell);
+    static void setGoal(cellindex cell);
 
+    // Calls visit(cell) for each goal cell, in order of index
+    template <typename Visit>
+    static void forEachGoal(Visit visit);
+
+    static twobyte getDistance(cellindex cell);
+    static void setDistance(cellindex cell, twobyte distance);
+    static twobyte getEstimate(cellindex cell);
+    static void setEstimate(cellindex cell, twobyte estimate);
+    static void clearAllEstimates();
+    static twobyte getPriority(cellindex cell);
+    static bool getDiscovered(cellindex cell);
+    static void setDiscovered(cellindex cell, bool discovered);
+    static bool hasNext(cellindex cell);
+    static void clearNext(cellindex cell);
+    static byte getNextDirection(cellindex cell);
+    static void setNextDirection(cellindex cell, byte nextDirection);
+    static byte getStraightAwayLength(cellindex cell);
+    static void setStraightAwayLength(cellindex cell, byte straightAwayLength);
+
+};
+
+template <byte W, byte H>
+THREAD_LOCAL rowword BasicMaze<W, H>::m_horizontalKnown[] = {0};
+
+template <byte W, byte H>
+THREAD_LOCAL rowword BasicMaze<W, H>::m_horizontalWalls[] = {0};
+
+template <byte W, byte H>
+THREAD_LOCAL rowword BasicMaze<W, H>::m_verticalKnown[] = {0};
+
+template <byte W, byte H>
+THREAD_LOCAL rowword BasicMaze<W, H>::m_verticalWalls[] = {0};
+
+template <byte W, byte H>
+THREAD_LOCAL unsigned int BasicMaze<W, H>::m_version = 0;
+
+template <byte W, byte H>
+THREAD_LOCAL byte BasicMaze<W, H>::m_width = W;
+
+template <byte W, byte H>
+THREAD_LOCAL byte BasicMaze<W, H>::m_height = H;
+
+template <byte W, byte H>
+THREAD_LOCAL celldistance BasicMaze<W, H>::m_distance[] = {0};
+
+template <byte W, byte H>
+THREAD_LOCAL celldistance BasicMaze<W, H>::m_estimate[] = {0};
+
+template <byte W, byte H>
+THREAD_LOCAL byte BasicMaze<W, H>::m_straightAwayLength[] = {0};
+
+template <byte W, byte H>
+THREAD_LOCAL byte BasicMaze<W, H>::m_nextDirection[] = {0};
+
+template <byte W, byte H>
+THREAD_LOCAL unsigned long long BasicMaze<W, H>::m_discovered[] = {0};
+
+template <byte W, byte H>
+THREAD_LOCAL unsigned long long BasicMaze<W, H>::m_hasNext[] = {0};
+
+template <byte W, byte H>
+THREAD_LOCAL unsigned long long BasicMaze<W, H>::m_goal[] = {0};
+
+template <byte W, byte H>
+const int BasicMaze<W, H>::OFFSETS[] = {
+    1, static_cast<int>(STRIDE), -1, -static_cast<int>(STRIDE)
 };
+
+template <byte W, byte H>
+THREAD_LOCAL byte BasicMaze<W, H>::m_neighbors[] = {0};
+
+template <byte W, byte H>
+inline void BasicMaze<W, H>::clear() {
+    for (twobyte i = 0; i < MAX_HEIGHT * ROW_WORDS; i += 1) {
+        m_horizontalKnown[i] = 0;
+        m_horizontalWalls[i] = 0;
+        m_verticalKnown[i] = 0;
+        m_verticalWalls[i] = 0;
+    }
+    m_version += 1;
+    std::memset(m_distance, 0, sizeof(m_distance));
+    clearAllEstimates();
+    std::memset(m_straightAwayLength, 0, sizeof(m_straightAwayLength));
+    std::memset(m_nextDirection, 0, sizeof(m_nextDirection));
+    clearAllDiscovered();
+    clearAllNext();
+    clearAllGoals();
+}
+
+template <byte W, byte H>
+inline void BasicMaze<W, H>::setSize(byte width, byte height) {
+    m_width = width;
+    m_height = height;
+    for (byte x = 0; x < W; x += 1) {
+        for (byte y = 0; y < H; y += 1) {
+            byte neighbors = 0;
+            if (x < width && y < height) {
+                neighbors |= (y < height - 1 ? 1 : 0) << Direction::NORTH;
+                neighbors |= (x < width  - 1 ? 1 : 0) << Direction::EAST;
+                neighbors |= (0 < y          ? 1 : 0) << Direction::SOUTH;
+                neighbors |= (0 < x          ? 1 : 0) << Direction::WEST;
+            }
+            m_neighbors[getCell(x, y)] = neighbors;
+        }
+    }
+}
+
+template <byte W, byte H>
+inline byte BasicMaze<W, H>::getWidth() {
+    return m_width;
+}
+
+template <byte W, byte H>
+inline byte BasicMaze<W, H>::getHeight() {
+    return m_height;
+}
+
+template <byte W, byte H>
+inline byte BasicMaze<W, H>::getCLLX() {
+    return (m_width - 1) / 2;
+}
+
+template <byte W, byte H>
+inline byte BasicMaze<W, H>::getCLLY() {
+    return (m_height - 1) / 2;
+}
+
+template <byte W, byte H>
+inline byte BasicMaze<W, H>::getCURX() {
+    return m_width / 2;
+}
+
+template <byte W, byte H>
+inline byte BasicMaze<W, H>::getCURY() {
+    return m_height / 2;
+}
+
+template <byte W, byte H>
+inline byte BasicMaze<W, H>::getX(cellindex cell) {
+    return cell >> SHIFT;
+}
+
+template <byte W, byte H>
+inline byte BasicMaze<W, H>::getY(cellindex cell) {
+    return cell & (STRIDE - 1);
+}
+
+template <byte W, byte H>
+inline cellindex BasicMaze<W, H>::getCell(byte x, byte y) {
+    return x << SHIFT | y;
+}
+
+template <byte W, byte H>
+inline bool BasicMaze<W, H>::hasNeighbor(cellindex cell, byte direction) {
+    return (m_neighbors[cell] >> direction) & 1;
+}
+
+template <byte W, byte H>
+inline cellindex BasicMaze<W, H>::getNeighbor(cellindex cell, byte direction) {
+    return cell + OFFSETS[direction];
+}
+
+template <byte W, byte H>
+inline byte BasicMaze<W, H>::getOpenDirections(cellindex cell) {
+    byte x = getX(cell);
+    byte y = getY(cell);
+    twobyte index = y * ROW_WORDS + x / WORD_BITS;
+    rowword bit = static_cast<rowword>(1) << (x % WORD_BITS);
+    byte open = 0;
+    if (y < MAX_HEIGHT - 1 && !(m_horizontalWalls[index] & bit)) {
+        open |= 1 << Direction::NORTH;
+    }
+    if (x < MAX_WIDTH - 1 && !(m_verticalWalls[index] & bit)) {
+        open |= 1 << Direction::EAST;
+    }
+    if (0 < y && !(m_horizontalWalls[index - ROW_WORDS] & bit)) {
+        open |= 1 << Direction::SOUTH;
+    }
+    if (0 < x) {
+        twobyte westIndex = y * ROW_WORDS + (x - 1) / WORD_BITS;
+        rowword westBit = static_cast<rowword>(1) << ((x - 1) % WORD_BITS);
+        if (!(m_verticalWalls[westIndex] & westBit)) {
+            open |= 1 << Direction::WEST;
+        }
+    }
+    return open;
+}
+
+template <byte W, byte H>
+inline unsigned int BasicMaze<W, H>::getVersion() {
+    return m_version;
+}
+
+template <byte W, byte H>
+inline bool BasicMaze<W, H>::isKnown(byte x, byte y, byte direction) {
+    return isKnown(getCell(x, y), direction);
+}
+
+template <byte W, byte H>
+inline bool BasicMaze<W, H>::isWall(byte x, byte y, byte direction) {
+    return isWall(getCell(x, y), direction);
+}
+
+template <byte W, byte H>
+inline void BasicMaze<W, H>::setWall(byte x, byte y, byte direction, bool isWall) {
+    setWall(getCell(x, y), direction, isWall);
+}
+
+template <byte W, byte H>
+inline void BasicMaze<W, H>::clearWall(byte x, byte y, byte direction) {
+    clearWall(getCell(x, y), direction);
+}
+
+template <byte W, byte H>
+inline bool BasicMaze<W, H>::isKnown(cellindex cell, byte direction) {
+    rowword* known;
+    rowword* walls;
+    rowword bit;
+    return !locateWall(cell, direction, &known, &walls, &bit) || (*known & bit);
+}
+
+template <byte W, byte H>
+inline bool BasicMaze<W, H>::isWall(cellindex cell, byte direction) {
+    rowword* known;
+    rowword* walls;
+    rowword bit;
+    return !locateWall(cell, direction, &known, &walls, &bit) || (*walls & bit);
+}
+
+template <byte W, byte H>
+inline void BasicMaze<W, H>::setWall(cellindex cell, byte direction, bool isWall) {
+    rowword* known;
+    rowword* walls;
+    rowword bit;
+    if (locateWall(cell, direction, &known, &walls, &bit)) {
+        *known |= bit;
+        if (static_cast<bool>(*walls & bit) != isWall) {
+            *walls ^= bit;
+            m_version += 1;
+        }
+    }
+}
+
+template <byte W, byte H>
+inline void BasicMaze<W, H>::clearWall(cellindex cell, byte direction) {
+    rowword* known;
+    rowword* walls;
+    rowword bit;
+    if (locateWall(cell, direction, &known, &walls, &bit)) {
+        *known &= ~bit;
+        if (*walls & bit) {
+            *walls &= ~bit;
+            m_version += 1;
+        }
+    }
+}
+
+template <byte W, byte H>
+inline bool BasicMaze<W, H>::locateWall(
+        cellindex cell,
+        byte direction,
+        rowword** known,
+        rowword** walls,
+        rowword* bit) {
+
+    // Walls on the south and west sides of a cell are stored as the walls on
+    // the north and east sides of the neighboring cell, respectively
+    byte x = getX(cell);
+    byte y = getY(cell);
+    bool vertical = false;
+    switch (direction) {
+        case Direction::NORTH:
+            if (y == MAX_HEIGHT - 1) {
+                return false;
+            }
+            break;
+        case Direction::EAST:
+            if (x == MAX_WIDTH - 1) {
+                return false;
+            }
+            vertical = true;
+            break;
+        case Direction::SOUTH:
+            if (y == 0) {
+                return false;
+            }
+            y -= 1;
+            break;
+        case Direction::WEST:
+            if (x == 0) {
+                return false;
+            }
+            x -= 1;
+            vertical = true;
+            break;
+    }
+
+    twobyte index = y * ROW_WORDS + x / WORD_BITS;
+    *known = (vertical ? m_verticalKnown : m_horizontalKnown) + index;
+    *walls = (vertical ? m_verticalWalls : m_horizontalWalls) + index;
+    *bit = static_cast<rowword>(1) << (x % WORD_BITS);
+    return true;
+}
+
+template <byte W, byte H>
+inline void BasicMaze<W, H>::clearAllDiscovered() {
+    std::memset(m_discovered, 0, sizeof(m_discovered));
+}
+
+template <byte W, byte H>
+inline void BasicMaze<W, H>::clearAllNext() {
+    std::memset(m_hasNext, 0, sizeof(m_hasNext));
+}
+
+template <byte W, byte H>
+inline void BasicMaze<W, H>::clearAllGoals() {
+    std::memset(m_goal, 0, sizeof(m_goal));
+}
+
+template <byte W, byte H>
+inline bool BasicMaze<W, H>::isGoal(cellindex cell) {
+    return (m_goal[cell / 64] >> (cell % 64)) & 1;
+}
+
+template <byte W, byte H>
+inline void BasicMaze<W, H>::setGoal(cellindex cell) {
+    m_goal[cell / 64] |= 1ULL << (cell % 64);
+}
+
+template <byte W, byte H>
+template <typename Visit>
+inline void BasicMaze<W, H>::forEachGoal(Visit visit) {
+    for (twobyte i = 0; i < PLANE_WORDS; i += 1) {
+        for (unsigned long long word = m_goal[i]; word; word &= word - 1) {
+            visit(static_cast<cellindex>(i * 64 + __builtin_ctzll(word)));
+        }
+    }
+}
+
+template <byte W, byte H>
+inline twobyte BasicMaze<W, H>::getDistance(cellindex cell) {
+    return m_distance[cell];
+}
+
+template <byte W, byte H>
+inline void BasicMaze<W, H>::setDistance(cellindex cell, twobyte distance) {
+    m_distance[cell] = distance;
+}
+
+template <byte W, byte H>
+inline twobyte BasicMaze<W, H>::getEstimate(cellindex cell) {
+    return m_estimate[cell];
+}
+
+template <byte W, byte H>
+inline void BasicMaze<W, H>::setEstimate(cellindex cell, twobyte estimate) {
+    m_estimate[cell] = estimate;
+}
+
+template <byte W, byte H>
+inline void BasicMaze<W, H>::clearAllEstimates() {
+    std::memset(m_estimate, 0, sizeof(m_estimate));
+}
+
+template <byte W, byte H>
+inline twobyte BasicMaze<W, H>::getPriority(cellindex cell) {
+    return m_distance[cell] + m_estimate[cell];
+}
+
+template <byte W, byte H>
+inline bool BasicMaze<W, H>::getDiscovered(cellindex cell) {
+    return (m_discovered[cell / 64] >> (cell % 64)) & 1;
+}
+
+template <byte W, byte H>
+inline void BasicMaze<W, H>::setDiscovered(cellindex cell, bool discovered) {
+    unsigned long long bit = 1ULL << (cell % 64);
+    m_discovered[cell / 64] = (m_discovered[cell / 64] & ~bit) | (discovered ? bit : 0);
+}
+
+template <byte W, byte H>
+inline bool BasicMaze<W, H>::hasNext(cellindex cell) {
+    return (m_hasNext[cell / 64] >> (cell % 64)) & 1;
+}
+
+template <byte W, byte H>
+inline void BasicMaze<W, H>::clearNext(cellindex cell) {
+    m_hasNext[cell / 64] &= ~(1ULL << (cell % 64));
+}
+
+template <byte W, byte H>
+inline byte BasicMaze<W, H>::getNextDirection(cellindex cell) {
+    return m_nextDirection[cell];
+}
+
+template <byte W, byte H>
+inline void BasicMaze<W, H>::setNextDirection(cellindex cell, byte nextDirection) {
+    m_hasNext[cell / 64] |= 1ULL << (cell % 64);
+    m_nextDirection[cell] = nextDirection;
+}
+
+template <byte W, byte H>
+inline byte BasicMaze<W, H>::getStraightAwayLength(cellindex cell) {
+    return m_straightAwayLength[cell];
+}
+
+template <byte W, byte H>
+inline void BasicMaze<W, H>::setStraightAwayLength(cellindex cell, byte straightAwayLength) {
+    m_straightAwayLength[cell] = straightAwayLength;
+}
+
+typedef BasicMaze<MAX_MAZE_SIZE, MAX_MAZE_SIZE> Maze;
@@ -7,5 +7,12 @@ struct Mode {
     static const byte CENTER = 0;
     static const byte ORIGIN = 1;
     static const byte GIVEUP = 2;
+    static const byte EXPLORE = 3;
+    static const byte DONE = 4;
+
+    static const char* name(byte mode) {
+        static const char* NAMES[] = {"center", "origin", "giveup", "explore", "done"};
+        return NAMES[mode];
+    }
 
 };
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cmath>
+
+// The physical characteristics of the mouse, used to estimate how long (in
+// seconds) the mouse takes to drive a path. Distances are in cells.
+struct MotionProfile {
+
+    // The acceleration (and deceleration) of the mouse, in cells/s^2
+    float acceleration = 16.0;
+
+    // The top speed on orthogonal and diagonal straightaways, in cells/s
+    float straightSpeed = 14.0;
+    float diagonalSpeed = 10.0;
+
+    // The speed at which the mouse takes (and enters and exits) turns
+    float turnSpeed = 4.0;
+
+    // The time taken to change heading by 45, 90, and 135 degrees while
+    // moving (including the arc itself), and to pivot 90 degrees in place
+    float turnTime[4] = {0.0, 0.065, 0.13, 0.2};
+    float pivotTime = 0.25;
+
+    // The time to drive a straightaway of the given length, starting and
+    // ending at turn speed, and otherwise accelerating up to top speed
+    float runTime(float distance, bool diagonal) const;
+
+};
+
+inline float MotionProfile::runTime(float distance, bool diagonal) const {
+    float topSpeed = diagonal ? diagonalSpeed : straightSpeed;
+    float rampDistance =
+        (topSpeed * topSpeed - turnSpeed * turnSpeed) / acceleration;
+    if (rampDistance <= distance) {
+        return 2 * (topSpeed - turnSpeed) / acceleration +
+            (distance - rampDistance) / topSpeed;
+    }
+    float peakSpeed = std::sqrt(turnSpeed * turnSpeed + acceleration * distance);
+    return 2 * (peakSpeed - turnSpeed) / acceleration;
+}
@@ -0,0 +1,60 @@
+#include "PathCache.h"
+
+#include "Assert.h"
+#include "Maze.h"
+
+THREAD_LOCAL PathCache::Entry PathCache::m_entries[PATH_CACHE_SIZE];
+THREAD_LOCAL byte PathCache::m_size = 0;
+THREAD_LOCAL byte PathCache::m_next = 0;
+
+void PathCache::clear() {
+    m_size = 0;
+    m_next = 0;
+}
+
+void PathCache::store(const PathKey& key) {
+    Entry& entry = m_entries[m_next];
+    entry.key = key;
+    entry.numMoves = 0;
+    cellindex current = key.start;
+    while (Maze::hasNext(current)) {
+        ASSERT_LT(entry.numMoves, Maze::MAX_CELLS);
+        byte direction = Maze::getNextDirection(current);
+        current = Maze::getNeighbor(current, direction);
+        entry.directions[entry.numMoves] = direction;
+        entry.straightAwayLengths[entry.numMoves] = Maze::getStraightAwayLength(current);
+        entry.numMoves += 1;
+    }
+    m_next = (m_next + 1) % PATH_CACHE_SIZE;
+    if (m_size < PATH_CACHE_SIZE) {
+        m_size += 1;
+    }
+}
+
+bool PathCache::restore(const PathKey& key) {
+    for (byte i = 0; i < m_size; i += 1) {
+        const Entry& entry = m_entries[i];
+        if (!matches(entry.key, key)) {
+            continue;
+        }
+        cellindex current = key.start;
+        for (twobyte j = 0; j < entry.numMoves; j += 1) {
+            Maze::setNextDirection(current, entry.directions[j]);
+            current = Maze::getNeighbor(current, entry.directions[j]);
+            Maze::setStraightAwayLength(current, entry.straightAwayLengths[j]);
+        }
+        Maze::clearNext(current);
+        return true;
+    }
+    return false;
+}
+
+bool PathCache::matches(const PathKey& one, const PathKey& two) {
+    return (
+        one.version == two.version &&
+        one.start == two.start &&
+        one.heading == two.heading &&
+        one.mode == two.mode &&
+        one.straightAwayLength == two.straightAwayLength
+    );
+}
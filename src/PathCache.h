@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Byte.h"
+#include "Maze.h"
+#include "ThreadLocal.h"
+
+// The number of paths remembered by the PathCache class. Each one takes two
+// bytes per cell of the maze.
+#ifndef PATH_CACHE_SIZE
+#define PATH_CACHE_SIZE 4
+#endif
+
+// Everything that a path planned by Dijkstra's algo depends on
+struct PathKey {
+    unsigned int version; // Of the walls (see Maze::getVersion())
+    cellindex start;
+    byte heading;
+    byte mode; // Which determines the destination
+    byte straightAwayLength; // Of the straightaway that ends at the start
+};
+
+class PathCache {
+
+    // The PathCache class remembers the last few paths that were planned, so
+    // that planning the same path again (e.g., the return to the origin, and
+    // the speed run back to the center, once the maze has been explored)
+    // is just a matter of copying it back into the maze. Paths are replaced
+    // in the order in which they were stored.
+
+public:
+
+    static void clear();
+
+    // Remembers the path that begins at the start of the key, i.e., the
+    // start's chain of "next" pointers, along with the straightaway length
+    // of each cell on the path (which the next path planned depends on)
+    static void store(const PathKey& key);
+
+    // Puts a remembered path back into the maze, or returns false if there
+    // isn't one for the given key
+    static bool restore(const PathKey& key);
+
+private:
+
+    struct Entry {
+        PathKey key;
+        twobyte numMoves;
+        byte directions[Maze::MAX_CELLS];
+        byte straightAwayLengths[Maze::MAX_CELLS];
+    };
+
+    static THREAD_LOCAL Entry m_entries[PATH_CACHE_SIZE];
+    static THREAD_LOCAL byte m_size;
+    static THREAD_LOCAL byte m_next;
+
+    static bool matches(const PathKey& one, const PathKey& two);
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Byte.h"
+
+// The compact binary framing of the mms protocol, which the mouse and a
+// simulator that supports it can agree to use in place of text lines (see
+// API::useBinaryProtocol()). The mouse asks for it by sending REQUEST as a
+// text line, and switches to it only if the reply is the text line ACCEPT.
+//
+// Every command is a single opcode byte, followed by its arguments packed as
+// bytes: x, y, and distance take one byte each, directions and colors are the
+// same characters as in the text protocol, and text is a length byte followed
+// by that many characters. Every query is answered by a single byte, which is
+// the value itself (the size, or 0 or 1), or, for moves and turns, 0 if the
+// mouse did so and anything else if it crashed.
+struct Protocol {
+
+    static constexpr const char* REQUEST = "binaryProtocol 1";
+    static constexpr const char* ACCEPT = "ack";
+
+    // Queries
+    static const byte MAZE_WIDTH = 1;
+    static const byte MAZE_HEIGHT = 2;
+    static const byte WALL_FRONT = 3;
+    static const byte WALL_RIGHT = 4;
+    static const byte WALL_LEFT = 5;
+    static const byte READ_WALLS = 6; // Answered as in API::readWalls()
+    static const byte MOVE_FORWARD = 7; // Followed by a distance
+    static const byte TURN_RIGHT = 8;
+    static const byte TURN_LEFT = 9;
+    static const byte WAS_RESET = 10;
+    static const byte ACK_RESET = 11;
+
+    // Commands, which aren't answered
+    static const byte SET_WALL = 12;
+    static const byte CLEAR_WALL = 13;
+    static const byte SET_COLOR = 14;
+    static const byte CLEAR_COLOR = 15;
+    static const byte CLEAR_ALL_COLOR = 16;
+    static const byte SET_TEXT = 17;
+    static const byte CLEAR_TEXT = 18;
+    static const byte CLEAR_ALL_TEXT = 19;
+
+    // The most bytes that a single command can take
+    static const twobyte MAX_FRAME = 4 + 255;
+
+};
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Byte.h"
+
+// A straight run of cells, preceded by a turn relative to the heading of the
+// mouse, which together form one motion primitive of a compiled path
+struct Segment {
+
+    // The turn is the number of clockwise quarter turns, i.e., one of
+    // 0 (none), 1 (right), 2 (around), or 3 (left)
+    byte turn;
+
+    // The number of cells to move forward after turning
+    byte length;
+
+};
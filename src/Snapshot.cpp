@@ -0,0 +1,109 @@
+#include "Snapshot.h"
+
+#include <fstream>
+
+#include "Direction.h"
+
+twobyte Snapshot::encode(const Pose& pose, byte* buffer) {
+    buffer[0] = 'M';
+    buffer[1] = 'K';
+    buffer[2] = VERSION;
+    buffer[3] = Maze::getWidth();
+    buffer[4] = Maze::getHeight();
+    buffer[5] = pose.x;
+    buffer[6] = pose.y;
+    buffer[7] = (pose.direction & 3) | (pose.mode & 7) << 2 | (pose.explored ? 1 : 0) << 5;
+
+    twobyte size = HEADER_SIZE;
+    twobyte numCells = 0;
+    for (byte y = 0; y < Maze::getHeight(); y += 1) {
+        for (byte x = 0; x < Maze::getWidth(); x += 1) {
+            cellindex cell = Maze::getCell(x, y);
+            byte nibble = 0;
+            if (Maze::isKnown(cell, Direction::NORTH)) {
+                nibble |= 1 | (Maze::isWall(cell, Direction::NORTH) ? 2 : 0);
+            }
+            if (Maze::isKnown(cell, Direction::EAST)) {
+                nibble |= 4 | (Maze::isWall(cell, Direction::EAST) ? 8 : 0);
+            }
+            if (numCells % 2 == 0) {
+                buffer[size] = nibble;
+            }
+            else {
+                buffer[size] |= nibble << 4;
+                size += 1;
+            }
+            numCells += 1;
+        }
+    }
+    if (numCells % 2 == 1) {
+        size += 1;
+    }
+
+    buffer[size] = checksum(buffer, size);
+    return size + 1;
+}
+
+bool Snapshot::decode(const byte* buffer, twobyte size, Pose* pose) {
+
+    // Check everything before touching the maze
+    twobyte numCells = Maze::getWidth() * Maze::getHeight();
+    twobyte expectedSize = HEADER_SIZE + (numCells + 1) / 2 + 1;
+    if (size != expectedSize ||
+        buffer[0] != 'M' ||
+        buffer[1] != 'K' ||
+        buffer[2] != VERSION ||
+        buffer[3] != Maze::getWidth() ||
+        buffer[4] != Maze::getHeight() ||
+        buffer[size - 1] != checksum(buffer, size - 1)) {
+        return false;
+    }
+
+    pose->x = buffer[5];
+    pose->y = buffer[6];
+    pose->direction = buffer[7] & 3;
+    pose->mode = (buffer[7] >> 2) & 7;
+    pose->explored = (buffer[7] >> 5) & 1;
+
+    twobyte i = 0;
+    for (byte y = 0; y < Maze::getHeight(); y += 1) {
+        for (byte x = 0; x < Maze::getWidth(); x += 1) {
+            cellindex cell = Maze::getCell(x, y);
+            byte nibble = (buffer[HEADER_SIZE + i / 2] >> (4 * (i % 2))) & 15;
+            if (nibble & 1) {
+                Maze::setWall(cell, Direction::NORTH, nibble & 2);
+            }
+            if (nibble & 4) {
+                Maze::setWall(cell, Direction::EAST, nibble & 8);
+            }
+            i += 1;
+        }
+    }
+    return true;
+}
+
+bool Snapshot::save(const char* path, const Pose& pose) {
+    static THREAD_LOCAL byte buffer[MAX_SIZE];
+    twobyte size = encode(pose, buffer);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(buffer), size);
+    return static_cast<bool>(file);
+}
+
+bool Snapshot::load(const char* path, Pose* pose) {
+    static THREAD_LOCAL byte buffer[MAX_SIZE];
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    file.read(reinterpret_cast<char*>(buffer), MAX_SIZE);
+    return decode(buffer, file.gcount(), pose);
+}
+
+byte Snapshot::checksum(const byte* buffer, twobyte size) {
+    byte sum = 0;
+    for (twobyte i = 0; i < size; i += 1) {
+        sum += buffer[i];
+    }
+    return sum;
+}
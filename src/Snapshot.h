@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Byte.h"
+#include "Maze.h"
+
+// Where the mouse was, and what it was doing, when a snapshot was taken
+struct Pose {
+    byte x;
+    byte y;
+    byte direction;
+    byte mode;
+    bool explored;
+};
+
+class Snapshot {
+
+    // The Snapshot class saves the wall knowledge of the maze, along with the
+    // pose of the mouse, in a compact binary format, so that a restart (e.g.,
+    // a power cycle between runs) doesn't cost us another search run. Since
+    // each wall is stored only once, only the north and east walls of each
+    // cell are saved, as a nibble per cell:
+    //
+    //            |------------------------------|
+    //     header |  'M' 'K' version width height |
+    //            |  x y direction/mode/explored  |
+    //            |------------------------------|
+    //      walls |  (width * height + 1) / 2     |
+    //            |------------------------------|
+    //   checksum |  sum of all preceding bytes   |
+    //            |------------------------------|
+    //
+    // Each nibble is, from the low bit, whether the north wall is known, its
+    // value, whether the east wall is known, and its value. The first cell of
+    // each byte is in the low nibble, and cells are in row-major order from
+    // (0, 0). A 16 x 16 maze takes 137 bytes, which fits easily in MCU flash.
+
+public:
+
+    static const byte VERSION = 1;
+    static const byte HEADER_SIZE = 8;
+    static const twobyte MAX_SIZE =
+        HEADER_SIZE + (Maze::MAX_WIDTH * Maze::MAX_HEIGHT + 1) / 2 + 1;
+
+    // Writes the maze and the pose to the buffer, which must be at least
+    // MAX_SIZE bytes, and returns the number of bytes written
+    static twobyte encode(const Pose& pose, byte* buffer);
+
+    // Validates the buffer, which must match the current maze size, and
+    // only then loads its walls into the maze. Returns false if invalid.
+    static bool decode(const byte* buffer, twobyte size, Pose* pose);
+
+    // Helpers for saving and loading snapshots to and from files
+    static bool save(const char* path, const Pose& pose);
+    static bool load(const char* path, Pose* pose);
+
+private:
+
+    static byte checksum(const byte* buffer, twobyte size);
+
+};
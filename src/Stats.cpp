@@ -0,0 +1,104 @@
+#include "Stats.h"
+
+const char* Stats::NAMES[] = {
+    "steps",
+    "plans",
+    "heap_pushes",
+    "heap_pops",
+    "heap_updates",
+    "relaxations",
+    "cells_moved",
+    "api_size_queries",
+    "api_wall_queries",
+    "api_moves",
+    "api_turns",
+    "api_reset_queries",
+    "api_commands",
+    "api_flushes",
+    "plan_ns",
+    "wait_ns",
+    "step_ns",
+    "speculations",
+    "speculation_hits",
+    "path_cache_hits",
+    "expansions",
+};
+
+THREAD_LOCAL unsigned long Stats::m_step[] = {0};
+THREAD_LOCAL unsigned long Stats::m_episode[] = {0};
+THREAD_LOCAL unsigned long Stats::m_run[] = {0};
+THREAD_LOCAL std::chrono::steady_clock::time_point Stats::m_start[NUM_COUNTERS];
+THREAD_LOCAL bool Stats::m_printedHeader = false;
+
+void Stats::clear() {
+    for (byte i = 0; i < NUM_COUNTERS; i += 1) {
+        m_step[i] = 0;
+        m_episode[i] = 0;
+        m_run[i] = 0;
+    }
+}
+
+unsigned long Stats::step(byte counter) {
+    return m_step[counter];
+}
+
+unsigned long Stats::total(byte counter) {
+    return m_run[counter] + m_step[counter];
+}
+
+void Stats::endStep() {
+    for (byte i = 0; i < NUM_COUNTERS; i += 1) {
+        m_episode[i] += m_step[i];
+        m_run[i] += m_step[i];
+        m_step[i] = 0;
+    }
+}
+
+void Stats::reportEpisode(std::ostream& out, const char* from, const char* to, bool json) {
+    report(out, from, to, m_episode, json);
+    for (byte i = 0; i < NUM_COUNTERS; i += 1) {
+        m_episode[i] = 0;
+    }
+}
+
+void Stats::reportRun(std::ostream& out, const char* event, bool json) {
+    report(out, event, "", m_run, json);
+}
+
+void Stats::report(
+        std::ostream& out,
+        const char* from,
+        const char* to,
+        const unsigned long* counters,
+        bool json) {
+
+    if (!ENABLED) {
+        return;
+    }
+
+    // Time spent computing is whatever wasn't spent waiting on the API
+    unsigned long computeNs = counters[STEP_NS] - counters[WAIT_NS];
+
+    if (json) {
+        out << "{\"from\":\"" << from << "\",\"to\":\"" << to << "\"";
+        for (byte i = 0; i < NUM_COUNTERS; i += 1) {
+            out << ",\"" << NAMES[i] << "\":" << counters[i];
+        }
+        out << ",\"compute_ns\":" << computeNs << "}" << std::endl;
+        return;
+    }
+
+    if (!m_printedHeader) {
+        out << "from,to";
+        for (byte i = 0; i < NUM_COUNTERS; i += 1) {
+            out << "," << NAMES[i];
+        }
+        out << ",compute_ns" << std::endl;
+        m_printedHeader = true;
+    }
+    out << from << "," << to;
+    for (byte i = 0; i < NUM_COUNTERS; i += 1) {
+        out << "," << counters[i];
+    }
+    out << "," << computeNs << std::endl;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <chrono>
+#include <ostream>
+
+#include "Byte.h"
+#include "ThreadLocal.h"
+
+// Instrumentation is on by default, and compiled out of release builds
+// (i.e., with -DNDEBUG) unless explicitly requested with -DSTATS=1
+#ifndef STATS
+#ifdef NDEBUG
+#define STATS 0
+#else
+#define STATS 1
+#endif
+#endif
+
+class Stats {
+
+    // The Stats class counts the work done by the planner, the mouse, and
+    // the API, so that the cost of each can be measured on its own (see also
+    // bench/). Counters are accumulated per step, and folded into per-episode
+    // (i.e., since the last mode transition) and per-run totals at the end of
+    // each step. Timers are counters too, in nanoseconds.
+
+public:
+
+    static const bool ENABLED = STATS;
+
+    static const byte STEPS = 0;
+    static const byte PLANS = 1;
+    static const byte HEAP_PUSHES = 2;
+    static const byte HEAP_POPS = 3;
+    static const byte HEAP_UPDATES = 4;
+    static const byte RELAXATIONS = 5;
+    static const byte CELLS_MOVED = 6;
+    static const byte API_SIZE_QUERIES = 7;
+    static const byte API_WALL_QUERIES = 8;
+    static const byte API_MOVES = 9;
+    static const byte API_TURNS = 10;
+    static const byte API_RESET_QUERIES = 11;
+    static const byte API_COMMANDS = 12;
+    static const byte API_FLUSHES = 13;
+    static const byte PLAN_NS = 14; // Time spent generating paths
+    static const byte WAIT_NS = 15; // Time spent blocked on API responses
+    static const byte STEP_NS = 16; // Time spent in steps, including the above
+    static const byte SPECULATIONS = 17; // Paths planned while the mouse moved
+    static const byte SPECULATION_HITS = 18; // Of those, the ones followed
+    static const byte PATH_CACHE_HITS = 19; // Paths restored from the PathCache
+    static const byte EXPANSIONS = 20; // Cells whose neighbors were searched
+    static const byte NUM_COUNTERS = 21;
+
+    static void clear();
+
+    static void count(byte counter, unsigned long amount = 1);
+    static void startTimer(byte timer);
+    static void stopTimer(byte timer);
+
+    // The value of a counter for the current step, or in total for the run
+    static unsigned long step(byte counter);
+    static unsigned long total(byte counter);
+
+    // Folds the current step's counters into the episode and run totals
+    static void endStep();
+
+    // Writes the episode (then resets it), or the run, as one line of JSON,
+    // or as one row of CSV (with a header before the first row)
+    static void reportEpisode(std::ostream& out, const char* from, const char* to, bool json);
+    static void reportRun(std::ostream& out, const char* event, bool json);
+
+private:
+
+    static const char* NAMES[NUM_COUNTERS];
+
+    static THREAD_LOCAL unsigned long m_step[NUM_COUNTERS];
+    static THREAD_LOCAL unsigned long m_episode[NUM_COUNTERS];
+    static THREAD_LOCAL unsigned long m_run[NUM_COUNTERS];
+    static THREAD_LOCAL std::chrono::steady_clock::time_point m_start[NUM_COUNTERS];
+    static THREAD_LOCAL bool m_printedHeader;
+
+    static void report(
+        std::ostream& out,
+        const char* from,
+        const char* to,
+        const unsigned long* counters,
+        bool json);
+
+};
+
+inline void Stats::count(byte counter, unsigned long amount) {
+    if (ENABLED) {
+        m_step[counter] += amount;
+    }
+}
+
+inline void Stats::startTimer(byte timer) {
+    if (ENABLED) {
+        m_start[timer] = std::chrono::steady_clock::now();
+    }
+}
+
+inline void Stats::stopTimer(byte timer) {
+    if (ENABLED) {
+        m_step[timer] += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - m_start[timer]
+        ).count();
+    }
+}
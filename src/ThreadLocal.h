@@ -0,0 +1,13 @@
+#pragma once
+
+// All of the solver's state lives in static members, one copy per thread, so
+// that independent solvers can run in parallel threads of a single process
+// (see the --threads option of the benchmark). The state grows with the
+// square of MAX_MAZE_SIZE, to about 4.4 MB at 255, and glibc puts each
+// thread's copy on that thread's stack, so the threads that run solvers need
+// stacks sized for it (see runThreads() in bench/Bench.cpp). Builds for
+// targets without threads (e.g., the robot itself) can pass -DTHREAD_LOCAL=
+// to make all of it plain static storage again.
+#ifndef THREAD_LOCAL
+#define THREAD_LOCAL thread_local
+#endif
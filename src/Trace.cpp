@@ -0,0 +1,24 @@
+#include "Trace.h"
+
+THREAD_LOCAL std::FILE* Trace::m_file = NULL;
+
+bool Trace::start(const char* path) {
+    if (m_file != NULL) {
+        std::fclose(m_file);
+    }
+    m_file = std::fopen(path, "wb");
+    if (m_file == NULL) {
+        return false;
+    }
+    std::fputc('M', m_file);
+    std::fputc('T', m_file);
+    std::fputc(VERSION, m_file);
+    flush();
+    return true;
+}
+
+void Trace::flush() {
+    if (m_file != NULL) {
+        std::fflush(m_file);
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstdio>
+
+#include "Byte.h"
+#include "ThreadLocal.h"
+
+class Trace {
+
+    // The Trace class records everything that the simulator told the mouse,
+    // and everything that the mouse did in return, in a compact binary format,
+    // so that a run can be reproduced without the simulator (see replay/).
+    // Visualization commands are left out, since nothing depends on them.
+    //
+    //            |------------------------------|
+    //     header |  'M' 'T' version             |
+    //            |------------------------------|
+    //     events |  kind << 4 | argument        |
+    //            |  (a value byte, if any)      |
+    //            |------------------------------|
+    //
+    // Each event is a byte, whose high nibble is its kind, and whose low
+    // nibble is its argument (see below). Sizes, and moves of more than
+    // MAX_SHORT_MOVE cells, are followed by a byte with their value. A step
+    // typically takes three or four bytes.
+    //
+    // The trace is written through as the run goes, and flushed whenever the
+    // mouse checks for a reset (i.e., once per step), so that at most a step
+    // is lost when the simulator kills the mouse. Note that a replay is only
+    // faithful if the mouse is built the same way, and doesn't load a
+    // Snapshot that wasn't there when the trace was recorded.
+
+public:
+
+    static const byte VERSION = 1;
+    static const byte HEADER_SIZE = 3;
+
+    // The kinds of events, and their arguments
+    static const byte SIZE = 0; // None, but followed by the width or height
+    static const byte WALLS = 1; // As answered by API::readWalls()
+    static const byte WALL = 2; // Turns from the front (0, 1, or 3) | wall << 2
+    static const byte RESET = 3; // Whether the reset button was pressed
+    static const byte ACK_RESET = 4; // None
+    static const byte MOVE_FORWARD = 5; // The distance, or 0 if followed by it
+    static const byte TURN_RIGHT = 6; // None
+    static const byte TURN_LEFT = 7; // None
+
+    static const byte MAX_SHORT_MOVE = 15;
+
+    static byte kind(byte event);
+    static byte argument(byte event);
+
+    // Starts writing a trace to the file at the given path, replacing it.
+    // Returns false if the file couldn't be opened.
+    static bool start(const char* path);
+    static bool isRecording();
+
+    // Appends an event to the trace, if one is being recorded
+    static void record(byte kind, byte argument = 0);
+    static void recordValue(byte kind, byte argument, byte value);
+    static void recordMove(int distance);
+
+    // Writes out everything recorded so far
+    static void flush();
+
+private:
+
+    static THREAD_LOCAL std::FILE* m_file;
+
+};
+
+inline byte Trace::kind(byte event) {
+    return event >> 4;
+}
+
+inline byte Trace::argument(byte event) {
+    return event & 15;
+}
+
+inline bool Trace::isRecording() {
+    return m_file != NULL;
+}
+
+inline void Trace::record(byte kind, byte argument) {
+    if (m_file != NULL) {
+        std::fputc(kind << 4 | argument, m_file);
+    }
+}
+
+inline void Trace::recordValue(byte kind, byte argument, byte value) {
+    if (m_file != NULL) {
+        std::fputc(kind << 4 | argument, m_file);
+        std::fputc(value, m_file);
+    }
+}
+
+inline void Trace::recordMove(int distance) {
+    if (distance <= MAX_SHORT_MOVE) {
+        record(MOVE_FORWARD, distance);
+    }
+    else {
+        recordValue(MOVE_FORWARD, 0, distance);
+    }
+}